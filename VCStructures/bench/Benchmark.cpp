@@ -0,0 +1,739 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/AdaptableHeap.h"
+#include "../src/ArrayRangedGraph.h"
+#include "../src/CheckPolicy.h"
+#include "../src/CompactRangedBuckets.h"
+#include "../src/ConcurrentRangedBuckets.h"
+#include "../src/IndexedRangedPriorityDeque.h"
+#include "../src/PositionalList.h"
+#include "../src/RadixAdaptableHeap.h"
+#include "../src/RangedAdaptablePriorityDeque.h"
+#include "../src/RangedGraph.h"
+#include "../src/RangedSort.h"
+#include "../src/RangedVertexCover.h"
+#include "../src/RelaxedRangedPriorityDeque.h"
+#include "../src/UnrolledPositionalList.h"
+#include "../src/UnrolledRangedGraph.h"
+#include "GraphGenerators.h"
+
+/**
+* Benchmarks for the VCStructures containers and the RangedVertexCover
+* heuristics.
+*
+* Every result is printed as one JSON object per line so that runs can be
+* diffed and tracked over time:
+*   {"suite": ..., "name": ..., "n": ..., "ns_per_op": ...,
+*    "peak_rss_kb": ..., "cover": ...}
+* For containers n is the number of elements and an op is one add, remove,
+* adapt or pop.  For vertex cover heuristics n is the number of edges and
+* ns_per_op is the heuristic's runtime divided by it.
+*
+* The relaxed suite also reports the rank error of RelaxedRangedPriorityDeque
+* pops, that is how many values of strictly higher key were still queued,
+* as "rank_error_mean" and "rank_error_max".  Its throughput cases pop from
+* every thread at once and report wall time per pop.
+*
+* The checks suite runs the same list and deque operations under each check
+* policy of CheckPolicy.h, to show what the precondition checks cost.
+*
+* The heap suite runs the same monotone workload (add, lower every key, pop
+* everything) on each adaptable queue over widening key ranges, counting
+* construction, to show where heaps overtake the buckets.
+*
+* The graph suite runs each adjacency representation on an Erdos-Renyi and
+* a power-law edge set, the latter to show removeVertex on hub vertices.
+*
+* peak_rss_kb is the process-wide high-water mark at the time the result is
+* printed, so it only ever grows over a run; compare it between runs of the
+* same case rather than between cases.
+*
+* Usage: Benchmark [--quick] [--threads N]
+*/
+
+typedef std::chrono::steady_clock Clock;
+
+static long peakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static double nsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+      .count();
+}
+
+/**
+* Keeps results alive so that the compiler cannot drop the measured work.
+*/
+static volatile std::int64_t sink;
+
+/**
+* @param extra Further fields, already formatted, or empty.
+*/
+static void emit(const char *suite, const std::string &name, long n,
+    double nsPerOp, long cover = -1, const std::string &extra = "") {
+  printf("{\"suite\": \"%s\", \"name\": \"%s\", \"n\": %ld, "
+      "\"ns_per_op\": %.2f, \"peak_rss_kb\": %ld", suite, name.c_str(), n,
+      nsPerOp, peakRssKb());
+  if (cover >= 0) {
+    printf(", \"cover\": %ld", cover);
+  }
+  if (!extra.empty()) {
+    printf(", %s", extra.c_str());
+  }
+  printf("}\n");
+  fflush(stdout);
+}
+
+static void listBenchmarks(int n) {
+  std::mt19937 rng(1);
+  std::vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = rng() % n;
+  }
+
+  {
+    Clock::time_point start = Clock::now();
+    std::list<int> list;
+    std::vector<std::list<int>::iterator> handles(n);
+    for (int i = 0; i < n; i++) {
+      handles[i] = list.insert(list.end(), i);
+    }
+    for (int i = 0; i < n; i++) {
+      list.erase(handles[i]);
+      handles[i] = list.insert(list.end(), order[i]);
+    }
+    sink = list.size();
+    emit("list", "std::list add/remove", n, nsSince(start) / (3.0 * n));
+  }
+
+  for (int pooled = 0; pooled < 2; pooled++) {
+    Clock::time_point start = Clock::now();
+    PositionPool<int> pool;
+    PositionalList<int> list(pooled ? &pool : nullptr);
+    std::vector<Position<int> *> handles(n);
+    for (int i = 0; i < n; i++) {
+      handles[i] = list.addLast(i);
+    }
+    for (int i = 0; i < n; i++) {
+      list.remove(handles[i]);
+      handles[i] = list.addLast(order[i]);
+    }
+    sink = list.size;
+    emit("list", pooled ? "PositionalList pooled add/remove" :
+        "PositionalList unpooled add/remove", n, nsSince(start) / (3.0 * n));
+  }
+
+  //Iteration once add/remove churn has scattered the nodes in memory.
+  {
+    PositionPool<int> pool;
+    PositionalList<int> list(&pool);
+    std::vector<Position<int> *> handles(n);
+    for (int i = 0; i < n; i++) {
+      handles[i] = list.addLast(i);
+    }
+    for (int i = 0; i < n; i++) {
+      list.remove(handles[order[i]]);
+      handles[order[i]] = list.addLast(order[i]);
+    }
+    Clock::time_point start = Clock::now();
+    std::int64_t total = 0;
+    for (int pass = 0; pass < 10; pass++) {
+      for (Position<int> *p = list.first(); p != list.end(); p = p->next) {
+        total += p->value;
+      }
+    }
+    sink = total;
+    emit("list", "PositionalList pooled iterate", n,
+        nsSince(start) / (10.0 * n));
+  }
+
+  {
+    Clock::time_point start = Clock::now();
+    UnrolledPool<int> pool;
+    UnrolledPositionalList<int> list(&pool);
+    std::vector<UnrolledSlot<int> *> handles(n);
+    for (int i = 0; i < n; i++) {
+      handles[i] = list.addLast(i);
+    }
+    for (int i = 0; i < n; i++) {
+      list.remove(handles[order[i]]);
+      handles[order[i]] = list.addLast(order[i]);
+    }
+    emit("list", "UnrolledPositionalList add/remove", n,
+        nsSince(start) / (3.0 * n));
+
+    start = Clock::now();
+    std::int64_t total = 0;
+    for (int pass = 0; pass < 10; pass++) {
+      list.foreach([&total](int value) { total += value; });
+    }
+    sink = total;
+    emit("list", "UnrolledPositionalList iterate", n,
+        nsSince(start) / (10.0 * n));
+  }
+}
+
+static void queueBenchmarks(int n, int keys) {
+  std::mt19937 rng(2);
+  std::vector<int> key(n), newKey(n);
+  for (int i = 0; i < n; i++) {
+    key[i] = rng() % keys;
+    newKey[i] = rng() % keys;
+  }
+
+  {
+    Clock::time_point start = Clock::now();
+    std::priority_queue<std::pair<int, int>> queue;
+    for (int i = 0; i < n; i++) {
+      queue.push(std::make_pair(key[i], i));
+    }
+    std::int64_t total = 0;
+    while (!queue.empty()) {
+      total += queue.top().second;
+      queue.pop();
+    }
+    sink = total;
+    emit("queue", "std::priority_queue add/pop", n,
+        nsSince(start) / (2.0 * n));
+  }
+
+  {
+    //Cost of the buckets alone: the bucket array plus any Positions drawn
+    //from the pool before anything is added.
+    Clock::time_point start = Clock::now();
+    RangedAdaptablePriorityDeque<int> deque(0, keys);
+    double ns = nsSince(start);
+    std::size_t bytes = deque.buckets * sizeof(BucketPositionalList<Empty, int>)
+        + deque.pool->slabs.size() * deque.pool->slabSize * sizeof(Position<int>);
+    emit("queue", "RangedAdaptablePriorityDeque construct", keys, ns / keys, -1,
+        "\"bytes_per_bucket\": " + std::to_string(bytes / deque.buckets));
+  }
+
+  {
+    RangedAdaptablePriorityDeque<int> deque(0, keys);
+    std::vector<Position<int> *> handles(n);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < n; i++) {
+      handles[i] = deque.add(key[i], i);
+    }
+    emit("queue", "RangedAdaptablePriorityDeque add", n, nsSince(start) / n);
+
+    start = Clock::now();
+    for (int i = 0; i < n; i++) {
+      deque.adapt(handles[i], newKey[i]);
+    }
+    emit("queue", "RangedAdaptablePriorityDeque adapt", n,
+        nsSince(start) / n);
+
+    start = Clock::now();
+    std::int64_t total = 0;
+    for (int i = 0; i < n; i++) {
+      total += i % 2 == 0 ? deque.popTop() : deque.popBottom();
+    }
+    sink = total;
+    emit("queue", "RangedAdaptablePriorityDeque pop", n, nsSince(start) / n);
+  }
+
+  {
+    IndexedRangedPriorityDeque<> deque(0, keys, n);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < n; i++) {
+      deque.add(key[i], i);
+    }
+    emit("queue", "IndexedRangedPriorityDeque add", n, nsSince(start) / n);
+
+    start = Clock::now();
+    for (int i = 0; i < n; i++) {
+      deque.adapt(i, newKey[i]);
+    }
+    emit("queue", "IndexedRangedPriorityDeque adapt", n, nsSince(start) / n);
+
+    start = Clock::now();
+    std::int64_t total = 0;
+    for (int i = 0; i < n; i++) {
+      total += i % 2 == 0 ? deque.popTop() : deque.popBottom();
+    }
+    sink = total;
+    emit("queue", "IndexedRangedPriorityDeque pop", n, nsSince(start) / n);
+  }
+
+  {
+    CompactRangedBuckets<int> buckets(0, keys, n);
+    std::vector<CompactRangedBuckets<int>::Handle> handles(n);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < n; i++) {
+      handles[i] = buckets.add(key[i], i);
+    }
+    for (int i = 0; i < n; i++) {
+      buckets.move(handles[i], newKey[i]);
+    }
+    for (int i = 0; i < n; i++) {
+      buckets.remove(handles[i]);
+    }
+    sink = buckets.size;
+    emit("queue", "CompactRangedBuckets add/move/remove", n,
+        nsSince(start) / (3.0 * n));
+  }
+}
+
+/**
+* Pooled list churn followed by deque add, adapt and pop, under policy C.
+*/
+template<class C>
+static void checkBenchmark(const std::string &policy, int n, int keys,
+    const std::vector<int> &key, const std::vector<int> &newKey) {
+  {
+    PositionPool<int> pool;
+    PositionalList<int, C> list(&pool);
+    std::vector<Position<int> *> handles(n);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < n; i++) {
+      handles[i] = list.addLast(i);
+    }
+    for (int i = 0; i < n; i++) {
+      list.remove(handles[i]);
+      handles[i] = list.addBefore(list.first(), i);
+    }
+    for (int i = 0; i < n; i++) {
+      list.removeLast();
+    }
+    sink = list.size;
+    emit("checks", "PositionalList<" + policy + "> add/remove", n,
+        nsSince(start) / (4.0 * n));
+  }
+
+  RangedAdaptablePriorityDeque<int, C> deque(0, keys);
+  std::vector<Position<int> *> handles(n);
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < n; i++) {
+    handles[i] = deque.add(key[i], i);
+  }
+  for (int i = 0; i < n; i++) {
+    deque.adapt(handles[i], newKey[i]);
+  }
+  std::int64_t total = 0;
+  for (int i = 0; i < n; i++) {
+    total += deque.popTop();
+  }
+  sink = total;
+  emit("checks", "RangedAdaptablePriorityDeque<" + policy +
+      "> add/adapt/pop", n, nsSince(start) / (3.0 * n));
+}
+
+static void checkBenchmarks(int n, int keys) {
+  std::mt19937 rng(7);
+  std::vector<int> key(n), newKey(n);
+  for (int i = 0; i < n; i++) {
+    key[i] = rng() % keys;
+    newKey[i] = rng() % keys;
+  }
+  checkBenchmark<CheckedPolicy>("CheckedPolicy", n, keys, key, newKey);
+  checkBenchmark<AssertPolicy>("AssertPolicy", n, keys, key, newKey);
+  checkBenchmark<UncheckedPolicy>("UncheckedPolicy", n, keys, key, newKey);
+}
+
+/**
+* Adds n values with keys in [0, range), lowers each key, then pops them
+* all, as greedy max degree does.  Construction is timed too, since that is
+* where a wide key range costs the buckets.
+*/
+template<class Q>
+static void heapBenchmark(const std::string &name, int n, int range,
+    const std::vector<int> &key, const std::vector<int> &drop) {
+  Clock::time_point start = Clock::now();
+  Q queue(0, range);
+  std::vector<typename Q::Handle> handles(n);
+  for (int i = 0; i < n; i++) {
+    handles[i] = queue.add(key[i], i);
+  }
+  for (int i = 0; i < n; i++) {
+    queue.adapt(handles[i], key[i] - drop[i]);
+  }
+  std::int64_t total = 0;
+  while (queue.size > 0) {
+    total += queue.popTop();
+  }
+  sink = total;
+  emit("heap", name + " range=" + std::to_string(range), n,
+      nsSince(start) / (3.0 * n));
+}
+
+static void heapBenchmarks(int n) {
+  std::mt19937 rng(6);
+  for (long range = 16; range <= 64L * n && range <= (1L << 26); range *= 16) {
+    std::vector<int> key(n), drop(n);
+    for (int i = 0; i < n; i++) {
+      key[i] = rng() % range;
+      drop[i] = rng() % (key[i] + 1);
+    }
+    heapBenchmark<RangedAdaptablePriorityDeque<int>>(
+        "RangedAdaptablePriorityDeque", n, (int) range, key, drop);
+    heapBenchmark<DaryAdaptableHeap<int, 2>>("DaryAdaptableHeap<2>", n,
+        (int) range, key, drop);
+    heapBenchmark<DaryAdaptableHeap<int>>("DaryAdaptableHeap<4>", n,
+        (int) range, key, drop);
+    heapBenchmark<RadixAdaptableHeap<int>>("RadixAdaptableHeap", n,
+        (int) range, key, drop);
+  }
+}
+
+/**
+* Sorting edges by endpoint, as during ingest, and picking the highest
+* degrees, against the standard library.
+*/
+static void sortBenchmarks(int n) {
+  std::mt19937 rng(6);
+  std::vector<CSREndpoints> edges(8 * (std::size_t) n);
+  for (CSREndpoints &edge : edges) {
+    edge.left = rng() % n;
+    edge.right = rng() % n;
+  }
+  long m = (long) edges.size();
+  auto byLeft = [](const CSREndpoints &e) { return e.left; };
+
+  {
+    std::vector<CSREndpoints> copy = edges;
+    Clock::time_point start = Clock::now();
+    std::stable_sort(copy.begin(), copy.end(),
+        [](const CSREndpoints &a, const CSREndpoints &b) {
+          return a.left < b.left;
+        });
+    emit("sort", "std::stable_sort edges", m, nsSince(start) / m);
+  }
+  {
+    std::vector<CSREndpoints> copy = edges;
+    Clock::time_point start = Clock::now();
+    std::sort(copy.begin(), copy.end(),
+        [](const CSREndpoints &a, const CSREndpoints &b) {
+          return a.left < b.left;
+        });
+    emit("sort", "std::sort edges", m, nsSince(start) / m);
+  }
+  {
+    std::vector<CSREndpoints> out(edges.size());
+    Clock::time_point start = Clock::now();
+    countingSort(edges.data(), edges.size(), out.data(), 0, n, byLeft);
+    emit("sort", "countingSort edges", m, nsSince(start) / m);
+  }
+  {
+    std::vector<CSREndpoints> copy = edges;
+    Clock::time_point start = Clock::now();
+    radixSort(copy.data(), copy.size(), [](const CSREndpoints &e) {
+      return (std::uint32_t) e.left;
+    });
+    emit("sort", "radixSort edges", m, nsSince(start) / m);
+  }
+
+  std::vector<int> degree(n, 0);
+  for (const CSREndpoints &edge : edges) {
+    degree[edge.left]++;
+    degree[edge.right]++;
+  }
+  int maxDegree = *std::max_element(degree.begin(), degree.end());
+  std::vector<int> vertices(n);
+  for (int v = 0; v < n; v++) {
+    vertices[v] = v;
+  }
+  std::size_t k = n / 100 + 1;
+  {
+    std::vector<int> copy = vertices;
+    Clock::time_point start = Clock::now();
+    std::partial_sort(copy.begin(), copy.begin() + k, copy.end(),
+        [&degree](int a, int b) { return degree[a] > degree[b]; });
+    sink = copy[0];
+    emit("sort", "std::partial_sort top 1% degree", n, nsSince(start) / n);
+  }
+  {
+    Clock::time_point start = Clock::now();
+    std::vector<int> top = topK(vertices.data(), vertices.size(), k, 0,
+        maxDegree + 1, [&degree](int v) { return degree[v]; });
+    sink = top[0];
+    emit("sort", "topK top 1% degree", n, nsSince(start) / n);
+  }
+}
+
+/**
+* Pops everything from one thread, measuring how far each pop is from the
+* true maximum.  A Fenwick tree over keys counts the values still queued.
+*/
+static void rankErrorBenchmark(int n, int keys, unsigned shards) {
+  std::mt19937 rng(4);
+  RelaxedRangedPriorityDeque<int> deque(0, keys, n, shards);
+  std::vector<int> tree(keys + 1, 0);
+  for (int i = 0; i < n; i++) {
+    int key = rng() % keys;
+    deque.add(key, key);
+    for (int j = key + 1; j <= keys; j += j & -j) {
+      tree[j]++;
+    }
+  }
+  double total = 0;
+  long worst = 0;
+  long remaining = n;
+  int key;
+  while (deque.popTop(key)) {
+    //Values at or below key, so the rest are strictly above it.
+    long atOrBelow = 0;
+    for (int j = key + 1; j > 0; j -= j & -j) {
+      atOrBelow += tree[j];
+    }
+    long error = remaining - atOrBelow;
+    total += error;
+    worst = error > worst ? error : worst;
+    for (int j = key + 1; j <= keys; j += j & -j) {
+      tree[j]--;
+    }
+    remaining--;
+  }
+  char extra[128];
+  snprintf(extra, sizeof(extra),
+      "\"rank_error_mean\": %.2f, \"rank_error_max\": %ld", total / n, worst);
+  emit("relaxed", "RelaxedRangedPriorityDeque k=" + std::to_string(shards) +
+      " rank error", n, 0, -1, extra);
+}
+
+/**
+* Fills a queue and has every thread pop until it is empty.
+*/
+template<class Q>
+static void popThroughput(Q &queue, const std::string &name, int n,
+    unsigned threads) {
+  Clock::time_point start = Clock::now();
+  std::vector<std::thread> workers;
+  std::atomic<std::int64_t> total(0);
+  for (unsigned t = 0; t < threads; t++) {
+    workers.emplace_back([&queue, &total]() {
+      std::int64_t local = 0;
+      int value;
+      while (queue.popTop(value)) {
+        local += value;
+      }
+      total += local;
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  sink = total;
+  emit("relaxed", name + " pop x" + std::to_string(threads), n,
+      nsSince(start) / n);
+}
+
+static void relaxedBenchmarks(int n, int keys, unsigned threads) {
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+    threads = threads == 0 ? 1 : threads;
+  }
+  std::mt19937 rng(5);
+  std::vector<int> key(n);
+  for (int i = 0; i < n; i++) {
+    key[i] = rng() % keys;
+  }
+
+  {
+    ConcurrentRangedBuckets<int> buckets(0, keys, n);
+    for (int i = 0; i < n; i++) {
+      buckets.add(key[i], i);
+    }
+    popThroughput(buckets, "ConcurrentRangedBuckets", n, threads);
+  }
+  //Every shard spans the whole key range, so keep k modest.
+  std::vector<unsigned> shardCounts = {2};
+  if (2 * threads > 2) {
+    shardCounts.push_back(2 * threads);
+  }
+  for (unsigned shards : shardCounts) {
+    RelaxedRangedPriorityDeque<int> deque(0, keys, n, shards);
+    for (int i = 0; i < n; i++) {
+      deque.add(key[i], i);
+    }
+    popThroughput(deque, "RelaxedRangedPriorityDeque k=" +
+        std::to_string(shards), n, threads);
+    rankErrorBenchmark(n, keys, shards);
+  }
+}
+
+/**
+* Builds, scans and tears down a graph vertex by vertex, as the greedy
+* heuristics do.  An op is one edge.
+*/
+template<class G, class Scan>
+static void graphBenchmark(const std::string &name, int n,
+    const std::vector<CSREndpoints> &edges, Scan scan) {
+  long m = (long) edges.size();
+  Clock::time_point start = Clock::now();
+  G *graph = new G(0, n);
+  for (std::size_t i = 0; i < edges.size(); i++) {
+    graph->addEdge(edges[i].left, edges[i].right, (int) i);
+  }
+  emit("graph", name + " build", m, nsSince(start) / m);
+
+  start = Clock::now();
+  std::int64_t total = 0;
+  for (int v = 0; v < n; v++) {
+    total += scan(*graph, v);
+  }
+  sink = total;
+  emit("graph", name + " scan neighbors", m, nsSince(start) / (2.0 * m));
+
+  start = Clock::now();
+  for (int v = 0; v < n; v++) {
+    graph->removeVertex(v);
+  }
+  emit("graph", name + " removeVertex", m, nsSince(start) / m);
+  delete graph;
+}
+
+/**
+* Erdos-Renyi vertices all have about the same low degree; power-law hubs
+* are the low ids, so removeVertex drains the high-degree vertices first.
+*/
+static void graphBenchmarks(const char *family, int n,
+    const std::vector<CSREndpoints> &edges) {
+  typedef RangedGraph<int, int> Linked;
+  typedef ArrayRangedGraph<int, int> Array;
+  typedef UnrolledRangedGraph<int, int> Unrolled;
+  std::string prefix = std::string(family) + " ";
+  graphBenchmark<Linked>(prefix + "RangedGraph", n, edges,
+      [](Linked &g, int v) {
+        std::int64_t total = 0;
+        Vertex<int, int> *vertex = g.getVertex(v);
+        for (Position<Edge<int, int> *> *p = vertex->first();
+            p != vertex->end(); p = p->next) {
+          total += g.keyOf(p->value->neighbor(p));
+        }
+        return total;
+      });
+  graphBenchmark<Array>(prefix + "ArrayRangedGraph", n, edges,
+      [](Array &g, int v) {
+        std::int64_t total = 0;
+        g.foreachNeighbor(v, [&total](int neighbor, Array::Edge *) {
+          total += neighbor;
+        });
+        return total;
+      });
+  graphBenchmark<Unrolled>(prefix + "UnrolledRangedGraph", n, edges,
+      [](Unrolled &g, int v) {
+        std::int64_t total = 0;
+        g.foreachNeighbor(v, [&total](int neighbor, Unrolled::Edge *) {
+          total += neighbor;
+        });
+        return total;
+      });
+}
+
+static void coverBenchmarks(const char *family, int n,
+    std::vector<CSREndpoints> edges, unsigned threads) {
+  CSRRangedGraph graph(0, n, edges.data(), edges.size());
+  std::string prefix = std::string(family) + " ";
+  long m = (long) edges.size();
+  //The scanning heuristics are quadratic; keep them to small graphs.
+  bool scans = n <= 20000;
+
+  RangedVertexCover cover;
+  RangedVertexCover lazy(true);
+  RangedVertexCover heap(false, RangedVertexCover::DARY_HEAP);
+  RangedVertexCover radix(false, RangedVertexCover::RADIX_HEAP);
+  struct Run {
+    const char *name;
+    bool enabled;
+    RangedVertexCover *solver;
+    void (RangedVertexCover::*heuristic)(CSRRangedGraph *);
+  } runs[] = {
+    {"maxDegree", scans, &cover, &RangedVertexCover::maxDegreeApproximation},
+    {"minDegree", scans, &cover, &RangedVertexCover::minDegreeApproximation},
+    {"twoApproximation", true, &cover,
+        &RangedVertexCover::twoApproximation},
+    {"queueMaxDegree", true, &cover,
+        &RangedVertexCover::queueMaxDegreeApproximation},
+    {"queueMinDegree", true, &cover,
+        &RangedVertexCover::queueMinDegreeApproximation},
+    {"lazyQueueMaxDegree", true, &lazy,
+        &RangedVertexCover::queueMaxDegreeApproximation},
+    {"heapQueueMaxDegree", true, &heap,
+        &RangedVertexCover::queueMaxDegreeApproximation},
+    {"radixQueueMaxDegree", true, &radix,
+        &RangedVertexCover::queueMaxDegreeApproximation},
+    {"lazyQueueMinDegree", true, &lazy,
+        &RangedVertexCover::queueMinDegreeApproximation},
+  };
+  for (Run &run : runs) {
+    if (!run.enabled) {
+      continue;
+    }
+    (run.solver->*run.heuristic)(&graph);
+    graph.restore();
+    emit("cover", prefix + run.name, m, run.solver->runtime * 1e6 / m,
+        run.solver->value);
+  }
+
+  cover.parallelTwoApproximation(&graph, threads);
+  graph.restore();
+  emit("cover", prefix + "parallelTwoApproximation", m,
+      cover.runtime * 1e6 / m, cover.value);
+  cover.parallelMaxDegreeApproximation(&graph, threads);
+  graph.restore();
+  emit("cover", prefix + "parallelMaxDegree", m, cover.runtime * 1e6 / m,
+      cover.value);
+}
+
+int main(int argc, char **argv) {
+  bool quick = false;
+  unsigned threads = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quick") == 0) {
+      quick = true;
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = (unsigned) atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: %s [--quick] [--threads N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  std::vector<int> sizes = {10000, 100000, 1000000};
+  if (quick) {
+    sizes.resize(1);
+  }
+  for (int n : sizes) {
+    listBenchmarks(n);
+    queueBenchmarks(n, 1000);
+    queueBenchmarks(n, n);
+    checkBenchmarks(n, 1000);
+    heapBenchmarks(n);
+    relaxedBenchmarks(n, n, threads);
+    sortBenchmarks(n);
+    graphBenchmarks("erdosRenyi", n, erdosRenyi(n, 8 * (std::size_t) n, 7));
+    graphBenchmarks("powerLaw", n, powerLaw(n, 8 * (std::size_t) n, 2.1, 8));
+  }
+  for (int n : sizes) {
+    coverBenchmarks("erdosRenyi", n, erdosRenyi(n, 8 * (std::size_t) n, 3),
+        threads);
+    coverBenchmarks("powerLaw", n,
+        powerLaw(n, 8 * (std::size_t) n, 2.1, 4), threads);
+    int side = 1;
+    while ((side + 1) * (side + 1) <= n) {
+      side++;
+    }
+    coverBenchmarks("grid", side * side, grid(side, side), threads);
+  }
+  return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef GRAPH_GENERATORS__
+#define GRAPH_GENERATORS__
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../src/CSRRangedGraph.h"
+
+/**
+* Synthetic graphs for benchmarking, as edge arrays over vertices [0, n).
+* Every generator is deterministic for a given seed.
+*/
+
+/**
+* Erdős–Rényi G(n, m): m edges with uniformly random distinct endpoints.
+*/
+inline std::vector<CSREndpoints> erdosRenyi(int n, std::size_t m,
+    std::uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> pick(0, n - 1);
+  std::vector<CSREndpoints> edges;
+  edges.reserve(m);
+  while (edges.size() < m) {
+    int u = pick(rng);
+    int v = pick(rng);
+    if (u != v) {
+      edges.push_back({u, v});
+    }
+  }
+  return edges;
+}
+
+/**
+* Chung-Lu power-law graph: endpoints are drawn with probability
+* proportional to (i + 1)^(-1 / (exponent - 1)), which gives a degree
+* distribution with the given exponent.  A few hub vertices end up with very
+* high degree while most have very low degree.
+*/
+inline std::vector<CSREndpoints> powerLaw(int n, std::size_t m,
+    double exponent, std::uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<double> weights(n);
+  for (int i = 0; i < n; i++) {
+    weights[i] = std::pow(i + 1.0, -1.0 / (exponent - 1.0));
+  }
+  std::discrete_distribution<int> pick(weights.begin(), weights.end());
+  std::vector<CSREndpoints> edges;
+  edges.reserve(m);
+  while (edges.size() < m) {
+    int u = pick(rng);
+    int v = pick(rng);
+    if (u != v) {
+      edges.push_back({u, v});
+    }
+  }
+  return edges;
+}
+
+/**
+* rows x cols grid with 4-neighbor edges.  Every vertex has degree at most
+* four, so the degree buckets are few and dense.
+*/
+inline std::vector<CSREndpoints> grid(int rows, int cols) {
+  std::vector<CSREndpoints> edges;
+  edges.reserve(2 * (std::size_t) rows * cols);
+  for (int r = 0; r < rows; r++) {
+    for (int c = 0; c < cols; c++) {
+      int v = r * cols + c;
+      if (c + 1 < cols) {
+        edges.push_back({v, v + 1});
+      }
+      if (r + 1 < rows) {
+        edges.push_back({v, v + cols});
+      }
+    }
+  }
+  return edges;
+}
+
+#endif
@@ -0,0 +1,293 @@
+#ifndef ADAPTABLE_HEAP__
+#define ADAPTABLE_HEAP__
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "VCStats.h"
+
+/**
+* Slab allocator for heap entries, so that a handle is a plain pointer that
+* stays valid until its entry leaves the heap.  Removed entries are reused
+* before the slabs grow.
+*/
+template <typename N>
+class HeapEntrySlabs {
+  public:
+  /** Entries handed out per slab. */
+  static const std::size_t SLAB_SIZE = 1024;
+
+  HeapEntrySlabs() : used(SLAB_SIZE) {}
+
+  ~HeapEntrySlabs() {
+    release();
+  }
+
+  HeapEntrySlabs(const HeapEntrySlabs &) = delete;
+  HeapEntrySlabs &operator=(const HeapEntrySlabs &) = delete;
+
+  N *allocate() {
+    if (!freed.empty()) {
+      N *n = freed.back();
+      freed.pop_back();
+      return n;
+    }
+    if (used == SLAB_SIZE) {
+      slabs.push_back(new N[SLAB_SIZE]);
+      used = 0;
+    }
+    return slabs.back() + used++;
+  }
+
+  void free(N *n) {
+    freed.push_back(n);
+  }
+
+  void release() {
+    for (N *slab : slabs) {
+      delete[] slab;
+    }
+    slabs.clear();
+    freed.clear();
+    used = SLAB_SIZE;
+  }
+
+  private:
+  std::size_t used;
+  std::vector<N *> slabs;
+  std::vector<N *> freed;
+};
+
+/**
+* An entry of a DaryAdaptableHeap: the value and where it currently sits in
+* the heap.  The key lives in the heap array itself.
+*/
+template <typename T>
+struct DaryHeapEntry {
+  T value;
+  std::uint32_t index;
+};
+
+/**
+* Adaptable max-heap of integer keys with D children per node, for key
+* ranges too wide or too sparse for RangedAdaptablePriorityDeque.
+*
+* Shares the top half of the deque's interface: add returns a Handle that
+* adapt, eliminate and keyOf take, and topKey, peepTop and popTop read the
+* maximum.  Code written against that interface (see RangedVertexCover) can
+* switch between the two.  Insertion and key changes in either direction are
+* O(log_D n), pops O(D log_D n), and memory is O(n) whatever the key range.
+*
+* The heap array holds (key, entry) pairs, so comparisons never leave it.
+* It is 64 byte aligned and shifted by D - 1 slots, which puts the D
+* children of every node side by side at an aligned offset: with the
+* default D = 4 and 16 byte slots, each sift-down step reads exactly one
+* cache line.
+*/
+template <typename T, unsigned D = 4>
+class DaryAdaptableHeap {
+  public:
+  typedef DaryHeapEntry<T> Entry;
+  typedef Entry *Handle;
+
+  struct Slot {
+    int key;
+    Entry *entry;
+  };
+
+  static_assert(D >= 2, "A heap needs at least two children per node.");
+
+  /** Highest valid key, named as for RangedBuckets. */
+  int topBucket;
+  /** Lowest valid key. */
+  int bottomBucket;
+  /** Number of values in the heap. */
+  std::size_t size;
+
+  /**
+  * @param bottom The lowest valid key.
+  * @param top The highest valid key plus one.
+  * @param capacity Number of values to make room for up front.
+  */
+  DaryAdaptableHeap(int bottom, int top, std::size_t capacity = 0) :
+      topBucket(top - 1),
+      bottomBucket(bottom),
+      size(0),
+      storage(nullptr),
+      heap(nullptr),
+      capacity(0) {
+    reserve(capacity < 16 ? 16 : capacity);
+  }
+
+  ~DaryAdaptableHeap() {
+    ::free(storage);
+  }
+
+  DaryAdaptableHeap(const DaryAdaptableHeap &) = delete;
+  DaryAdaptableHeap &operator=(const DaryAdaptableHeap &) = delete;
+
+  void error() {
+    exit(1);
+  }
+
+#ifndef NO_CHECKS
+#define CHECK_HEAP_KEY(key) { \
+  if (key < bottomBucket || key > topBucket) error(); \
+}
+#define CHECK_HEAP_EMPTY if (size == 0) error();
+#else
+#define CHECK_HEAP_KEY(key)
+#define CHECK_HEAP_EMPTY
+#endif
+
+  Handle add(int key, T value) {
+    CHECK_HEAP_KEY(key)
+    if (size == capacity) {
+      reserve(2 * capacity);
+    }
+    Entry *entry = entries.allocate();
+    entry->value = value;
+    siftUp(Slot{key, entry}, (std::uint32_t) size++);
+    return entry;
+  }
+
+  int keyOf(Handle handle) {
+    return heap[handle->index].key;
+  }
+
+  /**
+  * Changes the key of a value.  The handle stays valid and is returned.
+  */
+  Handle adapt(Handle handle, int key) {
+    CHECK_HEAP_KEY(key)
+    std::uint32_t i = handle->index;
+    int old = heap[i].key;
+    if (key > old) {
+      siftUp(Slot{key, handle}, i);
+    } else if (key < old) {
+      siftDown(Slot{key, handle}, i);
+    }
+    return handle;
+  }
+
+  void eliminate(Handle handle) {
+    std::uint32_t i = handle->index;
+    Slot last = heap[--size];
+    entries.free(handle);
+    if (i == size) {
+      return;
+    }
+    if (last.key > heap[i].key) {
+      siftUp(last, i);
+    } else {
+      siftDown(last, i);
+    }
+  }
+
+  /**
+  * The highest key.  Only meaningful when not empty.
+  */
+  int topKey() {
+    return heap[0].key;
+  }
+
+  T peepTop() {
+    CHECK_HEAP_EMPTY
+    return heap[0].entry->value;
+  }
+
+  T popTop() {
+    CHECK_HEAP_EMPTY
+    VC_STAT(pops)
+    T value = heap[0].entry->value;
+    eliminate(heap[0].entry);
+    return value;
+  }
+
+  /**
+  * Removes every value, invalidating every handle.
+  */
+  void clear() {
+    entries.release();
+    size = 0;
+  }
+
+  private:
+  /** Unaligned start of the allocation holding heap. */
+  void *storage;
+  /** Slot 0 is the root; children of i are D * i + 1 through D * i + D. */
+  Slot *heap;
+  std::size_t capacity;
+  HeapEntrySlabs<Entry> entries;
+
+  void reserve(std::size_t slots) {
+    std::size_t bytes = (slots + D - 1) * sizeof(Slot) + 64;
+    void *grown = malloc(bytes);
+    if (grown == nullptr) {
+      error();
+    }
+    //Align slot -1 + D, so that child groups start on aligned offsets.
+    std::uintptr_t base =
+        ((std::uintptr_t) grown + 63) & ~(std::uintptr_t) 63;
+    Slot *aligned = (Slot *) base + (D - 1);
+    if (size > 0) {
+      memcpy(aligned, heap, size * sizeof(Slot));
+    }
+    ::free(storage);
+    storage = grown;
+    heap = aligned;
+    capacity = slots;
+  }
+
+  void place(Slot slot, std::uint32_t i) {
+    heap[i] = slot;
+    slot.entry->index = i;
+  }
+
+  /**
+  * Moves the hole at i up until slot fits, then fills it.
+  */
+  void siftUp(Slot slot, std::uint32_t i) {
+    while (i > 0) {
+      std::uint32_t parent = (i - 1) / D;
+      if (heap[parent].key >= slot.key) {
+        break;
+      }
+      place(heap[parent], i);
+      i = parent;
+    }
+    place(slot, i);
+  }
+
+  /**
+  * Moves the hole at i down until slot fits, then fills it.
+  */
+  void siftDown(Slot slot, std::uint32_t i) {
+    std::size_t n = size;
+    for (;;) {
+      std::size_t first = (std::size_t) D * i + 1;
+      if (first >= n) {
+        break;
+      }
+      std::size_t last = first + D < n ? first + D : n;
+      std::size_t best = first;
+      for (std::size_t c = first + 1; c < last; c++) {
+        if (heap[c].key > heap[best].key) {
+          best = c;
+        }
+      }
+      if (heap[best].key <= slot.key) {
+        break;
+      }
+      place(heap[best], i);
+      i = (std::uint32_t) best;
+    }
+    place(slot, i);
+  }
+};
+
+#endif
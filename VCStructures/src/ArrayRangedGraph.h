@@ -0,0 +1,218 @@
+#ifndef ARRAY_RANGED_GRAPH__
+#define ARRAY_RANGED_GRAPH__
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "VCStats.h"
+
+/**
+* An edge of an ArrayRangedGraph.  Besides its endpoints it records where it
+* sits in each endpoint's adjacency array, which is what makes removal O(1).
+*/
+template<class E>
+class ArrayEdge {
+  public:
+  E value;
+  int left;
+  int right;
+  std::uint32_t leftIndex;
+  std::uint32_t rightIndex;
+};
+
+/**
+* One entry of a vertex's adjacency array.  The neighbor is stored inline so
+* that scanning neighbors never has to touch the edges themselves.
+*/
+template<class E>
+struct ArrayIncidence {
+  int neighbor;
+  ArrayEdge<E> *edge;
+};
+
+template<class V, class E>
+class ArrayVertex {
+  public:
+  V value;
+  std::vector<ArrayIncidence<E>> adjacency;
+
+  int degree() const {
+    return (int) adjacency.size();
+  }
+};
+
+/**
+* RangedGraph with adjacency arrays instead of adjacency lists.
+*
+* RangedGraph links two Positions per edge so that an edge can unlink itself
+* in O(1).  Here each vertex keeps a contiguous array of incidences and each
+* edge remembers its index in both endpoints' arrays.  Removing an edge moves
+* the last incidence of each array into the hole and patches that
+* incidence's edge with its new index: still O(1), but with two pointers
+* per edge instead of eleven, and neighbor scans are sequential reads.
+*
+* Adjacency order is not preserved by removals.  removeVertex takes edges
+* from the back of the vertex's own array, so only the neighbors' arrays
+* ever need patching.
+*
+* Edges are carved out of slabs and recycled, as PositionPool does for
+* Positions, so an edge pointer is valid until that edge is removed.
+*/
+template<class V, class E>
+class ArrayRangedGraph {
+  public:
+  typedef ArrayEdge<E> Edge;
+  typedef ArrayVertex<V, E> Vertex;
+
+  /** Index of the top valid vertex. */
+  int topBucket;
+  /** Index of the bottom valid vertex. */
+  int bottomBucket;
+  /** Number of vertices. */
+  std::size_t buckets;
+  int edgeCount;
+
+  ArrayRangedGraph(int bottom, int top) :
+      topBucket(top - 1),
+      bottomBucket(bottom),
+      buckets(top - bottom),
+      edgeCount(0),
+      vertices(buckets) {}
+
+  /**
+  * Edges live in slabs owned by the graph, so remaining edges are freed all
+  * at once.
+  */
+  ~ArrayRangedGraph() {
+    for (Edge *slab : slabs) {
+      delete[] slab;
+    }
+  }
+
+  ArrayRangedGraph(const ArrayRangedGraph &) = delete;
+  ArrayRangedGraph &operator=(const ArrayRangedGraph &) = delete;
+
+  void error() {
+    exit(1);
+  }
+
+#ifndef NO_CHECKS
+#define CHECK_ARRAY_VERTEX(vertex) { \
+  if (vertex < bottomBucket || vertex > topBucket) error(); \
+}
+#else
+#define CHECK_ARRAY_VERTEX(vertex)
+#endif
+
+  Vertex *getVertex(int vertex) {
+    CHECK_ARRAY_VERTEX(vertex)
+    return &vertices[vertex - bottomBucket];
+  }
+
+  int degree(int vertex) {
+    return getVertex(vertex)->degree();
+  }
+
+  const ArrayIncidence<E> *begin(int vertex) {
+    return getVertex(vertex)->adjacency.data();
+  }
+
+  const ArrayIncidence<E> *end(int vertex) {
+    Vertex *v = getVertex(vertex);
+    return v->adjacency.data() + v->adjacency.size();
+  }
+
+  /**
+  * Applies a function taking (neighbor, edge) to every edge of a vertex.
+  * The graph must not be modified meanwhile.
+  */
+  template<class F>
+  void foreachNeighbor(int vertex, F apply) {
+    for (const ArrayIncidence<E> *i = begin(vertex), *e = end(vertex); i != e;
+        i++) {
+      apply(i->neighbor, i->edge);
+    }
+  }
+
+  Edge *addEdge(int left, int right, E value) {
+    Vertex *l = getVertex(left);
+    Vertex *r = getVertex(right);
+    Edge *edge = allocateEdge();
+    edge->value = value;
+    edge->left = left;
+    edge->right = right;
+    edge->leftIndex = (std::uint32_t) l->adjacency.size();
+    l->adjacency.push_back(ArrayIncidence<E>{right, edge});
+    edge->rightIndex = (std::uint32_t) r->adjacency.size();
+    r->adjacency.push_back(ArrayIncidence<E>{left, edge});
+    edgeCount++;
+    return edge;
+  }
+
+  void removeEdge(Edge *edge) {
+    VC_STAT(edgesRemoved)
+    //Right first: for a self-loop, the right entry was pushed last.
+    detach(edge->right, edge->rightIndex);
+    detach(edge->left, edge->leftIndex);
+    freed.push_back(edge);
+    edgeCount--;
+  }
+
+  void removeVertex(int vertex) {
+    VC_STAT(verticesRemoved)
+    Vertex *v = getVertex(vertex);
+    while (!v->adjacency.empty()) {
+      removeEdge(v->adjacency.back().edge);
+    }
+  }
+
+  private:
+  /** Edges handed out per slab. */
+  static const std::size_t SLAB_SIZE = 1024;
+
+  std::vector<Vertex> vertices;
+  std::vector<Edge *> slabs;
+  /** Edges handed out from the last slab so far. */
+  std::size_t used = SLAB_SIZE;
+  /** Removed edges, reused before the slabs. */
+  std::vector<Edge *> freed;
+
+  Edge *allocateEdge() {
+    if (!freed.empty()) {
+      Edge *edge = freed.back();
+      freed.pop_back();
+      return edge;
+    }
+    if (used == SLAB_SIZE) {
+      slabs.push_back(new Edge[SLAB_SIZE]);
+      used = 0;
+    }
+    return slabs.back() + used++;
+  }
+
+  /**
+  * Removes the incidence at index from a vertex's array, moving the last
+  * incidence into its place.
+  */
+  void detach(int vertex, std::uint32_t index) {
+    std::vector<ArrayIncidence<E>> &adjacency = getVertex(vertex)->adjacency;
+    std::uint32_t last = (std::uint32_t) adjacency.size() - 1;
+    if (index != last) {
+      ArrayIncidence<E> moved = adjacency[last];
+      adjacency[index] = moved;
+      Edge *edge = moved.edge;
+      //A self-loop has both ends in this array; patch the end that moved.
+      if (edge->left == vertex && edge->leftIndex == last) {
+        edge->leftIndex = index;
+      } else {
+        edge->rightIndex = index;
+      }
+    }
+    adjacency.pop_back();
+  }
+};
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef CSR_RANGED_GRAPH__
+#define CSR_RANGED_GRAPH__
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "VCStats.h"
+
+/**
+* One edge of the input to CSRRangedGraph.
+*/
+struct CSREndpoints {
+  int left;
+  int right;
+};
+
+/**
+* One entry of a vertex's adjacency: the vertex on the other end and the
+* index of the edge in the original input.
+*/
+struct CSRIncidence {
+  int neighbor;
+  std::uint32_t edge;
+};
+
+/**
+* Immutable compressed-sparse-row counterpart to RangedGraph.
+*
+* Built in a few linear passes from an array of edges: degrees are counted,
+* prefix summed into row offsets, and the edges are then scattered into a
+* single adjacency array.  This is exactly a counting sort of the edge
+* endpoints keyed by vertex, the same idea RangedBuckets is built around,
+* but with every bucket packed back to back.  There is no allocation per edge.
+*
+* Edges are identified by their index in the input array, so any per-edge
+* values the user has can stay in their own array, indexed the same way.
+*
+* The structure itself never changes after construction.  Deletions go
+* into an overlay: a removed flag per edge plus a live degree per vertex,
+* which is enough for the vertex cover heuristics to call removeVertex and
+* removeEdge as they do on RangedGraph.  Scans skip removed edges.
+*/
+class CSRRangedGraph {
+  public:
+  /** Lowest valid vertex. */
+  int bottomVertex;
+  /** Highest valid vertex plus one. */
+  int topVertex;
+  /** Number of vertices. */
+  std::size_t vertices;
+  /** Number of edges, including removed ones. */
+  std::size_t edges;
+  /** Number of edges not yet removed. */
+  std::size_t edgeCount;
+
+  /**
+  * Row offsets, vertices + 1 of them.  The adjacency of vertex v is
+  * adjacency[offsets[v - bottomVertex], offsets[v - bottomVertex + 1]).
+  */
+  const std::uint64_t *offsets;
+  /** Two entries per edge, grouped by vertex. */
+  const CSRIncidence *adjacency;
+  /** Endpoints of each edge, by edge index. */
+  const CSREndpoints *endpoints;
+
+  /** Deletion overlay: non-zero once an edge has been removed. */
+  std::vector<std::uint8_t> removed;
+  /** Deletion overlay: live degree of each vertex. */
+  std::vector<int> degrees;
+
+  void error() {
+    exit(1);
+  }
+
+#ifndef NO_CHECKS
+#define CHECK_CSR_VERTEX(vertex) { \
+  if (vertex < bottomVertex || vertex >= topVertex) error(); \
+}
+#define CHECK_CSR_EDGE(edge) { if (edge >= edges) error(); }
+#else
+#define CHECK_CSR_VERTEX(vertex)
+#define CHECK_CSR_EDGE(edge)
+#endif
+
+  /**
+  * Builds the adjacency from an array of edges.
+  *
+  * @param bottom The lowest valid vertex.
+  * @param top The highest valid vertex plus one.
+  * @param input The edges.  Copied, so it may be discarded afterwards.
+  * @param count Number of edges.
+  */
+  CSRRangedGraph(int bottom, int top, const CSREndpoints *input,
+      std::size_t count) :
+      bottomVertex(bottom),
+      topVertex(top),
+      vertices(top - bottom),
+      edges(count),
+      edgeCount(count),
+      removed(count, 0),
+      degrees(top - bottom, 0) {
+    if (count > 0xFFFFFFFFu) error();
+    ownedOffsets.assign(vertices + 1, 0);
+    ownedAdjacency.resize(2 * count);
+    ownedEndpoints.assign(input, input + count);
+
+    //Pass one: count each vertex's degree.
+    for (std::size_t i = 0; i < count; i++) {
+      CHECK_CSR_VERTEX(input[i].left)
+      CHECK_CSR_VERTEX(input[i].right)
+      degrees[input[i].left - bottom]++;
+      degrees[input[i].right - bottom]++;
+    }
+    //Pass two: prefix sum into row offsets.
+    std::uint64_t running = 0;
+    for (std::size_t v = 0; v < vertices; v++) {
+      ownedOffsets[v] = running;
+      running += degrees[v];
+    }
+    ownedOffsets[vertices] = running;
+    //Pass three: scatter each edge into both of its endpoints' rows.
+    std::vector<std::uint64_t> cursor(ownedOffsets.begin(),
+        ownedOffsets.end() - 1);
+    for (std::size_t i = 0; i < count; i++) {
+      int left = input[i].left;
+      int right = input[i].right;
+      ownedAdjacency[cursor[left - bottom]++] = {right, (std::uint32_t) i};
+      ownedAdjacency[cursor[right - bottom]++] = {left, (std::uint32_t) i};
+    }
+
+    offsets = ownedOffsets.data();
+    adjacency = ownedAdjacency.data();
+    endpoints = ownedEndpoints.data();
+  }
+
+  /**
+  * Takes ownership of adjacency arrays that were filled in by the caller,
+  * for builders such as the parallel text parser that scatter straight into
+  * the final arrays.
+  *
+  * @param bottom The lowest valid vertex.
+  * @param top The highest valid vertex plus one.
+  * @param offsets Row offsets, top - bottom + 1 of them.
+  * @param adjacency Two entries per edge, grouped by vertex.
+  * @param endpoints Endpoints of each edge.
+  */
+  CSRRangedGraph(int bottom, int top, std::vector<std::uint64_t> &&offsets,
+      std::vector<CSRIncidence> &&adjacency,
+      std::vector<CSREndpoints> &&endpoints) :
+      bottomVertex(bottom),
+      topVertex(top),
+      vertices(top - bottom),
+      edges(endpoints.size()),
+      edgeCount(endpoints.size()),
+      removed(endpoints.size(), 0),
+      degrees(top - bottom, 0),
+      ownedOffsets(std::move(offsets)),
+      ownedAdjacency(std::move(adjacency)),
+      ownedEndpoints(std::move(endpoints)) {
+    this->offsets = ownedOffsets.data();
+    this->adjacency = ownedAdjacency.data();
+    this->endpoints = ownedEndpoints.data();
+    for (std::size_t v = 0; v < vertices; v++) {
+      degrees[v] = (int) (this->offsets[v + 1] - this->offsets[v]);
+    }
+  }
+
+  /**
+  * Wraps adjacency arrays that already exist elsewhere, such as a mapped
+  * graph file.  Nothing is copied; the arrays must outlive the graph.  Only
+  * the deletion overlay is allocated.
+  *
+  * @param bottom The lowest valid vertex.
+  * @param top The highest valid vertex plus one.
+  * @param offsets Row offsets, top - bottom + 1 of them.
+  * @param adjacency Two entries per edge, grouped by vertex.
+  * @param endpoints Endpoints of each edge.
+  * @param count Number of edges.
+  */
+  CSRRangedGraph(int bottom, int top, const std::uint64_t *offsets,
+      const CSRIncidence *adjacency, const CSREndpoints *endpoints,
+      std::size_t count) :
+      bottomVertex(bottom),
+      topVertex(top),
+      vertices(top - bottom),
+      edges(count),
+      edgeCount(count),
+      offsets(offsets),
+      adjacency(adjacency),
+      endpoints(endpoints),
+      removed(count, 0),
+      degrees(top - bottom, 0) {
+    for (std::size_t v = 0; v < vertices; v++) {
+      degrees[v] = (int) (offsets[v + 1] - offsets[v]);
+    }
+  }
+
+  /**
+  * offsets, adjacency and endpoints may point into this graph's own
+  * storage, which a copy would keep pointing at.
+  */
+  CSRRangedGraph(const CSRRangedGraph &) = delete;
+  CSRRangedGraph &operator=(const CSRRangedGraph &) = delete;
+
+  /** Live degree of a vertex. */
+  int degree(int vertex) {
+    CHECK_CSR_VERTEX(vertex)
+    return degrees[vertex - bottomVertex];
+  }
+
+  /** Degree of a vertex before any removals. */
+  std::size_t originalDegree(int vertex) {
+    CHECK_CSR_VERTEX(vertex)
+    std::size_t v = vertex - bottomVertex;
+    return offsets[v + 1] - offsets[v];
+  }
+
+  const CSRIncidence *begin(int vertex) {
+    CHECK_CSR_VERTEX(vertex)
+    return adjacency + offsets[vertex - bottomVertex];
+  }
+
+  const CSRIncidence *end(int vertex) {
+    CHECK_CSR_VERTEX(vertex)
+    return adjacency + offsets[vertex - bottomVertex + 1];
+  }
+
+  bool isRemoved(std::size_t edge) {
+    CHECK_CSR_EDGE(edge)
+    return removed[edge] != 0;
+  }
+
+  /**
+  * Applies a function taking (neighbor, edge) to every live edge of a vertex.
+  */
+  template<class F>
+  void foreachNeighbor(int vertex, F apply) {
+    for (const CSRIncidence *i = begin(vertex), *e = end(vertex); i != e;
+        i++) {
+      if (removed[i->edge] == 0) {
+        apply(i->neighbor, (std::size_t) i->edge);
+      }
+    }
+  }
+
+  /**
+  * Removes an edge from the overlay.  Removing it twice does nothing.
+  */
+  void removeEdge(std::size_t edge) {
+    if (markRemoved(edge)) {
+      settleRemoved(edge);
+    }
+  }
+
+  /**
+  * First half of a removal split in two, for threads removing disjoint sets
+  * of edges at once: flags the edge removed but leaves degrees and
+  * edgeCount alone.  Distinct edges may be marked concurrently.  Every edge
+  * for which this returns true must then be passed once to settleRemoved,
+  * from one thread, before the degrees are read.
+  *
+  * @return Whether the edge was live.
+  */
+  bool markRemoved(std::size_t edge) {
+    CHECK_CSR_EDGE(edge)
+    if (removed[edge] != 0) {
+      return false;
+    }
+    removed[edge] = 1;
+    return true;
+  }
+
+  /**
+  * Second half of a split removal: takes an edge flagged by markRemoved out
+  * of its endpoints' degrees and edgeCount, as removeEdge does.
+  */
+  void settleRemoved(std::size_t edge) {
+    CHECK_CSR_EDGE(edge)
+    //Endpoints may come from a mapped file rather than the constructor.
+    CHECK_CSR_VERTEX(endpoints[edge].left)
+    CHECK_CSR_VERTEX(endpoints[edge].right)
+    VC_STAT(edgesRemoved)
+    degrees[endpoints[edge].left - bottomVertex]--;
+    degrees[endpoints[edge].right - bottomVertex]--;
+    edgeCount--;
+  }
+
+  /**
+  * Removes every live edge of a vertex.
+  */
+  void removeVertex(int vertex) {
+    VC_STAT(verticesRemoved)
+    if (degree(vertex) == 0) {
+      return;
+    }
+    for (const CSRIncidence *i = begin(vertex), *e = end(vertex); i != e;
+        i++) {
+      removeEdge(i->edge);
+    }
+  }
+
+  /**
+  * Undoes every removal, returning the graph to its built state.
+  */
+  void restore() {
+    for (std::uint8_t &flag : removed) {
+      flag = 0;
+    }
+    for (std::size_t v = 0; v < vertices; v++) {
+      degrees[v] = (int) (offsets[v + 1] - offsets[v]);
+    }
+    edgeCount = edges;
+  }
+
+  private:
+  std::vector<std::uint64_t> ownedOffsets;
+  std::vector<CSRIncidence> ownedAdjacency;
+  std::vector<CSREndpoints> ownedEndpoints;
+
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef CHECK_POLICY__
+#define CHECK_POLICY__
+
+#include <assert.h>
+#include <stdlib.h>
+
+/**
+* Policies for the precondition checks of PositionalList, RangedBuckets and
+* RangedAdaptablePriorityDeque: that a Position belongs to the list it is
+* handed to, that a key is in range, and that a pop has something to pop.
+*
+* The policy is a template parameter, so checked and unchecked containers can
+* live in the same binary: hot loops can drop the checks while ingest and
+* API boundaries keep them.  Every check reads
+*   if (C::CHECKS && condition) C::fail();
+* and compiles away entirely when CHECKS is false.
+*/
+
+/**
+* Checks always, and exits on failure like the containers' error().
+*/
+struct CheckedPolicy {
+  static const bool CHECKS = true;
+
+  static void fail() {
+    exit(1);
+  }
+};
+
+/**
+* Checks through assert: aborts in debug builds, where a debugger or core
+* dump shows the caller, and costs nothing once NDEBUG is defined.
+*/
+struct AssertPolicy {
+#ifdef NDEBUG
+  static const bool CHECKS = false;
+#else
+  static const bool CHECKS = true;
+#endif
+
+  static void fail() {
+    assert(!"Container precondition violated.");
+  }
+};
+
+/**
+* Never checks.  Passing a bad Position or key is undefined behavior.
+*/
+struct UncheckedPolicy {
+  static const bool CHECKS = false;
+
+  static void fail() {}
+};
+
+/**
+* Policy of containers that do not name one.  Defining NO_CHECKS still turns
+* their checks off, as it does for the other containers.
+*/
+#ifdef NO_CHECKS
+typedef UncheckedPolicy DefaultCheckPolicy;
+#else
+typedef CheckedPolicy DefaultCheckPolicy;
+#endif
+
+#endif
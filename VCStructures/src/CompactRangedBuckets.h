@@ -0,0 +1,214 @@
+#ifndef COMPACT_RANGED_BUCKETS__
+#define COMPACT_RANGED_BUCKETS__
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+* Index-based counterpart to RangedBuckets.
+*
+* Instead of each Position being its own heap node carrying a container
+* pointer and two neighbor pointers, every node lives in one contiguous array
+* and links to its neighbors with 32 bit indices.  There is no back-pointer
+* to the bucket: the first `buckets` slots of the array are circular sentinels,
+* one per bucket, so unlinking a node only needs its own links.  For a
+* pointer-sized payload this takes a node from 32 bytes down to 16, and
+* walking a bucket touches a single array.
+*
+* Handles returned by add are indices into the node array.  They stay valid
+* until the node is removed, even as the array grows.
+*
+* The trade off against RangedBuckets is that buckets do not track their own
+* sizes (only whether they are empty), and there is no per-bucket value.
+*/
+template<class P>
+class CompactRangedBuckets {
+  public:
+  typedef std::uint32_t Handle;
+
+  /** Marks the end of the free list. */
+  static const Handle NONE = 0xFFFFFFFFu;
+
+  struct Node {
+    P value;
+    Handle next;
+    Handle previous;
+  };
+
+  /**
+  * All nodes.  Slots [0, buckets) are the bucket sentinels; the rest hold
+  * values or sit on the free list.
+  */
+  std::vector<Node> nodes;
+
+  /** Index of the top valid bucket. */
+  int topBucket;
+  /** Index of the bottom valid bucket. */
+  int bottomBucket;
+  /** Number of items in buckets. */
+  std::size_t size;
+  /** Number of buckets. */
+  std::size_t buckets;
+  /** Head of the free list, threaded through Node::next. */
+  Handle freeList;
+
+  /**
+  * Constructor for CompactRangedBuckets.
+  *
+  * @param bottom The lowest valid bucket.
+  * @param top The highest valid bucket plus one.
+  * @param capacity Number of values to reserve room for up front.
+  */
+  CompactRangedBuckets(int bottom, int top, std::size_t capacity = 0) :
+      topBucket(top - 1),
+      bottomBucket(bottom),
+      size(0),
+      buckets(top - bottom),
+      freeList(NONE) {
+    nodes.reserve(buckets + capacity);
+    nodes.resize(buckets);
+    for (std::size_t i = 0; i < buckets; i++) {
+      nodes[i].next = (Handle) i;
+      nodes[i].previous = (Handle) i;
+    }
+  }
+
+  void error() {
+    exit(1);
+  }
+
+#ifndef NO_CHECKS
+#define CHECK_COMPACT_BOUNDS(bucket) { \
+  if (bucket < bottomBucket || bucket > topBucket) error(); \
+}
+#define CHECK_COMPACT_HANDLE(handle) { \
+  if (handle < buckets || handle >= nodes.size()) error(); \
+}
+#else
+#define CHECK_COMPACT_BOUNDS(bucket)
+#define CHECK_COMPACT_HANDLE(handle)
+#endif
+
+  /**
+  * Sentinel slot of the given bucket.
+  */
+  Handle sentinel(int bucket) {
+    CHECK_COMPACT_BOUNDS(bucket)
+    return (Handle) (bucket - bottomBucket);
+  }
+
+  bool empty(int bucket) {
+    Handle s = sentinel(bucket);
+    return nodes[s].next == s;
+  }
+
+  /**
+  * First handle in the given bucket, or its sentinel if it is empty.
+  */
+  Handle first(int bucket) {
+    return nodes[sentinel(bucket)].next;
+  }
+
+  /**
+  * Last handle in the given bucket, or its sentinel if it is empty.
+  */
+  Handle last(int bucket) {
+    return nodes[sentinel(bucket)].previous;
+  }
+
+  /**
+  * Whether a handle is a sentinel, i.e. the end of a bucket walk.
+  */
+  bool isSentinel(Handle handle) {
+    return handle < buckets;
+  }
+
+  Handle next(Handle handle) {
+    return nodes[handle].next;
+  }
+
+  Handle previous(Handle handle) {
+    return nodes[handle].previous;
+  }
+
+  P &value(Handle handle) {
+    CHECK_COMPACT_HANDLE(handle)
+    return nodes[handle].value;
+  }
+
+  /**
+  * Adds a value at the end of the given bucket.
+  * @param bucket The given bucket.
+  * @param value The given value.
+  * @return A handle to the value that stays valid until it is removed.
+  */
+  Handle add(int bucket, P value) {
+    Handle handle;
+    if (freeList != NONE) {
+      handle = freeList;
+      freeList = nodes[handle].next;
+    } else {
+      if (nodes.size() >= NONE) error();
+      handle = (Handle) nodes.size();
+      nodes.push_back(Node());
+    }
+    nodes[handle].value = value;
+    link(handle, sentinel(bucket));
+    size++;
+    return handle;
+  }
+
+  /**
+  * Removes the given handle.  Its slot is recycled by a later add.
+  */
+  void remove(Handle handle) {
+    CHECK_COMPACT_HANDLE(handle)
+    unlink(handle);
+    nodes[handle].next = freeList;
+    freeList = handle;
+    size--;
+  }
+
+  /**
+  * Moves a handle to the end of another bucket.  The handle stays the same.
+  */
+  void move(Handle handle, int bucket) {
+    CHECK_COMPACT_HANDLE(handle)
+    unlink(handle);
+    link(handle, sentinel(bucket));
+  }
+
+  /**
+  * Empties every bucket and forgets every handle in O(buckets).
+  */
+  void clear() {
+    nodes.resize(buckets);
+    for (std::size_t i = 0; i < buckets; i++) {
+      nodes[i].next = (Handle) i;
+      nodes[i].previous = (Handle) i;
+    }
+    freeList = NONE;
+    size = 0;
+  }
+
+  private:
+  void link(Handle handle, Handle s) {
+    Handle tail = nodes[s].previous;
+    nodes[handle].previous = tail;
+    nodes[handle].next = s;
+    nodes[tail].next = handle;
+    nodes[s].previous = handle;
+  }
+
+  void unlink(Handle handle) {
+    Node &node = nodes[handle];
+    nodes[node.previous].next = node.next;
+    nodes[node.next].previous = node.previous;
+  }
+
+};
+
+#endif
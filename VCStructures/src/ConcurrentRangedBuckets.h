@@ -0,0 +1,430 @@
+#ifndef CONCURRENT_RANGED_BUCKETS__
+#define CONCURRENT_RANGED_BUCKETS__
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+/**
+* Test-and-set lock for short critical sections.  Yields after spinning for a
+* while, so that oversubscribed threads still make progress.
+*/
+class SpinLock {
+  public:
+  std::atomic_flag flag = ATOMIC_FLAG_INIT;
+
+  void lock() {
+    int spins = 0;
+    while (flag.test_and_set(std::memory_order_acquire)) {
+      if (++spins == 64) {
+        spins = 0;
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void unlock() {
+    flag.clear(std::memory_order_release);
+  }
+};
+
+/**
+* Thread-safe counterpart to RangedBuckets.
+*
+* Each bucket is an intrusive circular list behind its own SpinLock, so
+* threads working in different buckets never contend.  add, remove and move
+* may be called from any number of threads at once, as may popTop and
+* popBottom.  A move locks both buckets involved, lower key first.
+*
+* Nodes live in one array sized up front and are never freed or reused
+* before clear(), so a handle can always be read safely even while another
+* thread pops or removes it.  Each node's key is atomic and set to NO_KEY
+* once it leaves the buckets; remove and move re-check it under the bucket
+* lock and return false if the node is already gone.  A move changes the
+* key straight from the old bucket to the new one, so a node being moved is
+* never seen as gone.  Which of two racing operations on one node wins is up
+* to the caller.
+*
+* Occupancy is a two-level bitmap of atomic words, so finding the extreme
+* buckets does not take any lock.  Pops are not strictly ordered against
+* concurrent adds: each takes the highest (or lowest) bucket occupied when it
+* looked.  RelaxedRangedPriorityDeque shards several of these to spread the
+* contention on the extreme buckets.
+*/
+template<class P>
+class ConcurrentRangedBuckets {
+  public:
+  /** Key of a node that is not in any bucket. */
+  static const int NO_KEY = INT_MIN;
+
+  struct Node {
+    P value;
+    Node *next;
+    Node *previous;
+    std::atomic<int> key;
+  };
+
+  typedef Node *Handle;
+
+  /** Index of the top valid bucket. */
+  int topBucket;
+  /** Index of the bottom valid bucket. */
+  int bottomBucket;
+  /** Number of buckets. */
+  std::size_t buckets;
+  /** Maximum number of adds before clear(). */
+  std::size_t capacity;
+
+  /**
+  * @param bottom The lowest valid bucket.
+  * @param top The highest valid bucket plus one.
+  * @param capacity Maximum number of values added before clear().
+  */
+  ConcurrentRangedBuckets(int bottom, int top, std::size_t capacity) :
+      topBucket(top - 1),
+      bottomBucket(bottom),
+      buckets(top - bottom),
+      capacity(capacity),
+      size_(0),
+      allocated(0),
+      data(new Bucket[buckets]),
+      nodes(new Node[capacity]),
+      words((buckets + 63) / 64),
+      occupied(new std::atomic<std::uint64_t>[words]),
+      summaryWords((words + 63) / 64),
+      summary(new std::atomic<std::uint64_t>[summaryWords]) {
+    for (std::size_t i = 0; i < buckets; i++) {
+      data[i].head.next = &data[i].head;
+      data[i].head.previous = &data[i].head;
+      data[i].count = 0;
+    }
+    for (std::size_t i = 0; i < words; i++) {
+      occupied[i].store(0, std::memory_order_relaxed);
+    }
+    for (std::size_t i = 0; i < summaryWords; i++) {
+      summary[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void error() {
+    exit(1);
+  }
+
+#ifndef NO_CHECKS
+#define CHECK_CONCURRENT_BOUNDS(bucket) { \
+  if (bucket < bottomBucket || bucket > topBucket) error(); \
+}
+#else
+#define CHECK_CONCURRENT_BOUNDS(bucket)
+#endif
+
+  /**
+  * Number of values in the buckets.  Counts a value from just before it is
+  * linked until just after it is unlinked, so it is never below the number
+  * of values a pop could find.
+  */
+  std::size_t size() {
+    return size_.load();
+  }
+
+  /**
+  * Current key of a handle, or NO_KEY if it has been removed or popped.
+  */
+  int keyOf(Handle handle) {
+    return handle->key.load();
+  }
+
+  /**
+  * Adds a value at the end of the given bucket.
+  * @return A handle to the value, readable until clear().
+  */
+  Handle add(int key, P value) {
+    Handle handle = tryAdd(key, value);
+    if (handle == nullptr) {
+      error();
+    }
+    return handle;
+  }
+
+  /**
+  * Like add, but returns null instead of failing once capacity is used up.
+  */
+  Handle tryAdd(int key, P value) {
+    CHECK_CONCURRENT_BOUNDS(key)
+    if (allocated.load() >= capacity) {
+      return nullptr;
+    }
+    std::size_t slot = allocated.fetch_add(1);
+    if (slot >= capacity) {
+      return nullptr;
+    }
+    Node *node = nodes.get() + slot;
+    node->value = value;
+    size_.fetch_add(1);
+    Bucket &b = bucket(key);
+    b.lock.lock();
+    link(b, node, key);
+    b.lock.unlock();
+    return node;
+  }
+
+  /**
+  * Removes a value from its bucket.
+  * @return False if it was already removed or popped.
+  */
+  bool remove(Handle handle) {
+    while (true) {
+      int key = handle->key.load();
+      if (key == NO_KEY) {
+        return false;
+      }
+      Bucket &b = bucket(key);
+      b.lock.lock();
+      if (handle->key.load() != key) {
+        b.lock.unlock();
+        continue;
+      }
+      unlink(b, handle);
+      b.lock.unlock();
+      size_.fetch_sub(1);
+      return true;
+    }
+  }
+
+  /**
+  * Moves a value to the end of another bucket.
+  * @return False if it was already removed or popped.
+  */
+  bool move(Handle handle, int key) {
+    CHECK_CONCURRENT_BOUNDS(key)
+    while (true) {
+      int current = handle->key.load();
+      if (current == NO_KEY) {
+        return false;
+      }
+      if (current == key) {
+        return true;
+      }
+      Bucket &from = bucket(current);
+      Bucket &to = bucket(key);
+      Bucket &first = current < key ? from : to;
+      Bucket &second = current < key ? to : from;
+      first.lock.lock();
+      second.lock.lock();
+      if (handle->key.load() != current) {
+        second.lock.unlock();
+        first.lock.unlock();
+        continue;
+      }
+      detach(from, handle, current);
+      attach(to, handle, key);
+      handle->key.store(key);
+      second.lock.unlock();
+      first.lock.unlock();
+      return true;
+    }
+  }
+
+  /**
+  * Pops the first value of the highest occupied bucket.
+  * @return False if the buckets are empty.
+  */
+  bool popTop(P &value) {
+    return pop(value, true);
+  }
+
+  /**
+  * Pops the first value of the lowest occupied bucket.
+  * @return False if the buckets are empty.
+  */
+  bool popBottom(P &value) {
+    return pop(value, false);
+  }
+
+  /**
+  * Highest occupied bucket, or bottomBucket - 1 if none was seen.
+  */
+  int topKey() {
+    for (std::size_t s = summaryWords; s-- > 0;) {
+      std::uint64_t summaryBits = summary[s].load();
+      while (summaryBits != 0) {
+        int high = 63 - __builtin_clzll(summaryBits);
+        std::size_t w = s * 64 + high;
+        std::uint64_t bits = occupied[w].load();
+        if (bits != 0) {
+          return bottomBucket + (int) (w * 64 + 63 - __builtin_clzll(bits));
+        }
+        summaryBits &= ~(1ULL << high);
+      }
+    }
+    return bottomBucket - 1;
+  }
+
+  /**
+  * Lowest occupied bucket, or topBucket + 1 if none was seen.
+  */
+  int bottomKey() {
+    for (std::size_t s = 0; s < summaryWords; s++) {
+      std::uint64_t summaryBits = summary[s].load();
+      while (summaryBits != 0) {
+        int low = __builtin_ctzll(summaryBits);
+        std::size_t w = s * 64 + low;
+        std::uint64_t bits = occupied[w].load();
+        if (bits != 0) {
+          return bottomBucket + (int) (w * 64 + __builtin_ctzll(bits));
+        }
+        summaryBits &= summaryBits - 1;
+      }
+    }
+    return topBucket + 1;
+  }
+
+  /**
+  * Empties every bucket and makes all capacity available again.  Not
+  * thread-safe: every handle is invalidated.
+  */
+  void clear() {
+    for (std::size_t i = 0; i < buckets; i++) {
+      data[i].head.next = &data[i].head;
+      data[i].head.previous = &data[i].head;
+      data[i].count = 0;
+    }
+    for (std::size_t i = 0; i < words; i++) {
+      occupied[i].store(0);
+    }
+    for (std::size_t i = 0; i < summaryWords; i++) {
+      summary[i].store(0);
+    }
+    size_.store(0);
+    allocated.store(0);
+  }
+
+  private:
+  /**
+  * One cache line per bucket, so that threads working in neighboring
+  * buckets do not bounce each other's locks.
+  */
+  struct alignas(64) Bucket {
+    SpinLock lock;
+    std::size_t count;
+    Node head;
+  };
+
+  std::atomic<std::size_t> size_;
+  std::atomic<std::size_t> allocated;
+  std::unique_ptr<Bucket[]> data;
+  std::unique_ptr<Node[]> nodes;
+  std::size_t words;
+  /** One bit per bucket. */
+  std::unique_ptr<std::atomic<std::uint64_t>[]> occupied;
+  std::size_t summaryWords;
+  /** One bit per non-zero word of occupied. */
+  std::unique_ptr<std::atomic<std::uint64_t>[]> summary;
+
+  Bucket &bucket(int key) {
+    return data[key - bottomBucket];
+  }
+
+  /**
+  * Links a node at the end of a bucket and publishes its key.  The bucket
+  * must be locked.
+  */
+  void link(Bucket &b, Node *node, int key) {
+    attach(b, node, key);
+    node->key.store(key);
+  }
+
+  /**
+  * Unlinks a node from its bucket and marks it gone.  The bucket must be
+  * locked.
+  */
+  void unlink(Bucket &b, Node *node) {
+    detach(b, node, node->key.load());
+    node->key.store(NO_KEY);
+  }
+
+  /**
+  * Links a node at the end of the bucket of the given key, leaving the
+  * node's key alone.  The bucket must be locked.
+  */
+  void attach(Bucket &b, Node *node, int key) {
+    node->previous = b.head.previous;
+    node->next = &b.head;
+    b.head.previous->next = node;
+    b.head.previous = node;
+    if (b.count++ == 0) {
+      occupy(key);
+    }
+  }
+
+  /**
+  * Unlinks a node from the bucket of the given key, leaving the node's key
+  * alone.  The bucket must be locked.
+  */
+  void detach(Bucket &b, Node *node, int key) {
+    node->previous->next = node->next;
+    node->next->previous = node->previous;
+    if (--b.count == 0) {
+      vacate(key);
+    }
+  }
+
+  void occupy(int key) {
+    std::size_t i = key - bottomBucket;
+    occupied[i / 64].fetch_or(1ULL << (i % 64));
+    summary[i / 4096].fetch_or(1ULL << (i / 64 % 64));
+  }
+
+  /**
+  * Clearing the summary bit can race with another bucket of the same word
+  * becoming occupied, so the word is checked again afterwards and the bit
+  * put back if needed.
+  */
+  void vacate(int key) {
+    std::size_t i = key - bottomBucket;
+    std::uint64_t bit = 1ULL << (i % 64);
+    if (occupied[i / 64].fetch_and(~bit) != bit) {
+      return;
+    }
+    std::uint64_t summaryBit = 1ULL << (i / 64 % 64);
+    summary[i / 4096].fetch_and(~summaryBit);
+    if (occupied[i / 64].load() != 0) {
+      summary[i / 4096].fetch_or(summaryBit);
+    }
+  }
+
+  /**
+  * Values counted in size but not yet visible in the bitmap are in the
+  * middle of an add or move, so an empty search only gives up once size
+  * says there is nothing left.
+  */
+  bool pop(P &value, bool top) {
+    while (size_.load() != 0) {
+      int key = top ? topKey() : bottomKey();
+      if (key < bottomBucket || key > topBucket) {
+        std::this_thread::yield();
+        continue;
+      }
+      Bucket &b = bucket(key);
+      b.lock.lock();
+      if (b.count == 0) {
+        b.lock.unlock();
+        continue;
+      }
+      Node *node = b.head.next;
+      unlink(b, node);
+      b.lock.unlock();
+      size_.fetch_sub(1);
+      value = node->value;
+      return true;
+    }
+    return false;
+  }
+};
+
+#endif
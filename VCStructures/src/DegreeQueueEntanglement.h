@@ -0,0 +1,167 @@
+#ifndef DEGREE_QUEUE_ENTANGLEMENT__
+#define DEGREE_QUEUE_ENTANGLEMENT__
+
+#include <vector>
+
+#include "RangedAdaptablePriorityDeque.h"
+#include "RangedGraph.h"
+
+/**
+* Every vertex of a RangedGraph in a RangedAdaptablePriorityDeque keyed by
+* its degree.
+*
+* A vertex's degree is the size of its bucket in the graph, so after any
+* edge change the affected vertices are simply moved to the bucket matching
+* their new size: O(1) per endpoint.  Vertices of degree zero stay queued in
+* bucket 0.
+*
+* Kept in sync by DegreeQueueEntanglement (for EntangledRangedGraph) or
+* DegreeQueueObserver (for StaticEntangledRangedGraph), so that heuristics
+* can take the queue as it stands instead of rebuilding it from the graph.
+*/
+template<class V, class E>
+class DegreeIndex {
+  public:
+  /** The degree queue, or null until sync is called. */
+  RangedAdaptablePriorityDeque<int> *queue;
+  /** Each vertex's position in queue. */
+  std::vector<Position<int> *> positions;
+  /** Lowest vertex of the graph. */
+  int bottomVertex;
+
+  DegreeIndex() : queue(nullptr), bottomVertex(0) {}
+
+  ~DegreeIndex() {
+    delete queue;
+  }
+
+  /**
+  * (Re)builds the queue from the graph's current degrees in O(V).
+  *
+  * @param maxDegree Highest degree the queue starts out holding.
+  * @param reserveDegree Highest degree the queue may grow to hold in place,
+  * when above maxDegree.  The queue doubles its range as degrees outgrow it;
+  * past the reservation, or with none, it is rebuilt with a reservation
+  * twice the new range, which moves every Position in positions.
+  */
+  void sync(RangedGraph<V, E> &graph, int maxDegree, int reserveDegree = 0) {
+    delete queue;
+    if (reserveDegree > maxDegree) {
+      queue = new RangedAdaptablePriorityDeque<int>(0, maxDegree + 1, 0,
+          reserveDegree + 1);
+    } else {
+      queue = new RangedAdaptablePriorityDeque<int>(0, maxDegree + 1);
+    }
+    bottomVertex = graph.bottomBucket;
+    positions.assign(graph.buckets, nullptr);
+    for (int v = graph.bottomBucket; v <= graph.topBucket; v++) {
+      positions[v - bottomVertex] = queue->add(graph.bucket(v)->size, v);
+    }
+  }
+
+  int degree(int vertex) {
+    return queue->keyOf(positions[vertex - bottomVertex]);
+  }
+
+  /**
+  * Moves a vertex to the bucket of its current degree in the graph.
+  */
+  void update(RangedGraph<V, E> &graph, int vertex) {
+    if (queue == nullptr) {
+      return;
+    }
+    int degree = graph.bucket(vertex)->size;
+    if (degree > queue->topBucket) {
+      int top = 2 * (queue->topBucket + 1);
+      top = top > degree + 1 ? top : degree + 1;
+      if (degree >= queue->reserveTop) {
+        //Rebuilding reads every degree, this vertex's included.
+        sync(graph, top - 1, 2 * top);
+        return;
+      }
+      queue->grow(0, top < queue->reserveTop ? top : queue->reserveTop);
+    }
+    Position<int> *p = positions[vertex - bottomVertex];
+    if (queue->keyOf(p) != degree) {
+      queue->adapt(p, degree);
+    }
+  }
+
+  void update(RangedGraph<V, E> &graph, const Edge<V, E> *edge) {
+    update(graph, graph.keyOf(edge->left));
+    update(graph, graph.keyOf(edge->right));
+  }
+};
+
+/**
+* Runtime entanglement keeping a DegreeIndex in sync with an
+* EntangledRangedGraph.  Entangles itself on construction and disentangles
+* on destruction, so either may be destroyed first.
+*/
+template<class V, class E>
+class DegreeQueueEntanglement :
+    public RangedGraphEntanglement<V, E>,
+    public DegreeIndex<V, E> {
+  public:
+  /**
+  * @param graph The graph to follow.
+  * @param maxDegree Highest degree the queue starts out holding.
+  * @param reserveDegree Highest degree the queue may grow to hold in place.
+  */
+  DegreeQueueEntanglement(EntangledRangedGraph<V, E> *graph, int maxDegree,
+      int reserveDegree = 0) {
+    this->sync(*graph, maxDegree, reserveDegree);
+    this->entangle(graph);
+  }
+
+  ~DegreeQueueEntanglement() {
+    if (this->graph != nullptr) {
+      this->disentangle();
+    }
+  }
+
+  void afterAddEdge(const Edge<V, E> *edge) {
+    this->update(*this->graph, edge);
+  }
+
+  /**
+  * The edge is gone by the time afterRemoveEdge runs, so its endpoints are
+  * kept here in between.
+  */
+  void beforeRemoveEdge(const Edge<V, E> *edge) {
+    removedLeft = this->graph->keyOf(edge->left);
+    removedRight = this->graph->keyOf(edge->right);
+  }
+
+  void afterRemoveEdge() {
+    this->update(*this->graph, removedLeft);
+    this->update(*this->graph, removedRight);
+  }
+
+  private:
+  int removedLeft;
+  int removedRight;
+};
+
+/**
+* Compile-time observer keeping a DegreeIndex in sync with a
+* StaticEntangledRangedGraph.  Observers are constructed before they can see
+* the graph, so call sync on graph.observer<DegreeQueueObserver<V, E>>()
+* once the graph exists.
+*/
+template<class V, class E>
+class DegreeQueueObserver :
+    public RangedGraphObserver<V, E>,
+    public DegreeIndex<V, E> {
+  public:
+  void afterAddEdge(RangedGraph<V, E> &graph, Edge<V, E> *edge) {
+    this->update(graph, edge);
+  }
+
+  void afterRemoveEdge(RangedGraph<V, E> &graph, int left, int right) {
+    this->update(graph, left);
+    this->update(graph, right);
+  }
+};
+
+#endif
@@ -0,0 +1,366 @@
+#ifndef GRAPH_FILE__
+#define GRAPH_FILE__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CSRRangedGraph.h"
+
+/**
+* On-disk layout of a CSRRangedGraph.
+*
+* The file is this header followed by the three arrays of a CSRRangedGraph,
+* each starting on a 64 byte boundary, in native byte order:
+*   offsets   - (vertices + 1) uint64 row offsets
+*   adjacency - 2 * edges CSRIncidence entries
+*   endpoints - edges CSREndpoints entries
+*
+* Because the arrays are stored exactly as CSRRangedGraph uses them, a file
+* can be mapped and handed to CSRRangedGraph without copying or parsing, and
+* every process mapping the same file shares one copy in the page cache.
+*/
+struct GraphFileHeader {
+  char magic[8];
+  std::uint32_t version;
+  /** Written as 1; reads differently on a machine of the other byte order. */
+  std::uint32_t byteOrder;
+  std::int32_t bottomVertex;
+  std::int32_t topVertex;
+  std::uint64_t vertices;
+  std::uint64_t edges;
+  /** Byte offsets of each array from the start of the file. */
+  std::uint64_t offsetsStart;
+  std::uint64_t adjacencyStart;
+  std::uint64_t endpointsStart;
+  /** Total size of the file in bytes. */
+  std::uint64_t fileSize;
+};
+
+static const char GRAPH_FILE_MAGIC[8] = {'V', 'C', 'G', 'R', 'A', 'P', 'H', 0};
+static const std::uint32_t GRAPH_FILE_VERSION = 1;
+
+/**
+* Rounds a byte offset up to the next section boundary.
+*/
+inline std::uint64_t graphFileAlign(std::uint64_t offset) {
+  return (offset + 63) & ~(std::uint64_t) 63;
+}
+
+/**
+* Fills in a header for a graph of the given shape, laying out the sections.
+*/
+inline GraphFileHeader graphFileHeader(int bottom, int top,
+    std::uint64_t edges) {
+  GraphFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+  header.version = GRAPH_FILE_VERSION;
+  header.byteOrder = 1;
+  header.bottomVertex = bottom;
+  header.topVertex = top;
+  header.vertices = (std::uint64_t) ((long long) top - bottom);
+  header.edges = edges;
+  header.offsetsStart = graphFileAlign(sizeof(GraphFileHeader));
+  header.adjacencyStart = graphFileAlign(header.offsetsStart +
+      (header.vertices + 1) * sizeof(std::uint64_t));
+  header.endpointsStart = graphFileAlign(header.adjacencyStart +
+      2 * edges * sizeof(CSRIncidence));
+  header.fileSize = header.endpointsStart + edges * sizeof(CSREndpoints);
+  return header;
+}
+
+/**
+* Writes a graph in the binary format.  Only the built structure is written;
+* the deletion overlay is not.
+*
+* @return Whether the whole file was written.
+*/
+inline bool writeGraphFile(const char *path, CSRRangedGraph &graph) {
+  FILE *file = fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  GraphFileHeader header = graphFileHeader(graph.bottomVertex,
+      graph.topVertex, graph.edges);
+  static const char padding[64] = {0};
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+  std::uint64_t written = sizeof(header);
+
+  const void *sections[3] = {graph.offsets, graph.adjacency, graph.endpoints};
+  std::uint64_t starts[3] = {header.offsetsStart, header.adjacencyStart,
+      header.endpointsStart};
+  std::uint64_t lengths[3] = {
+      (header.vertices + 1) * sizeof(std::uint64_t),
+      2 * header.edges * sizeof(CSRIncidence),
+      header.edges * sizeof(CSREndpoints)};
+  for (int i = 0; i < 3 && ok; i++) {
+    std::uint64_t gap = starts[i] - written;
+    ok = gap == 0 || fwrite(padding, 1, gap, file) == gap;
+    ok = ok && (lengths[i] == 0 ||
+        fwrite(sections[i], 1, lengths[i], file) == lengths[i]);
+    written = starts[i] + lengths[i];
+  }
+  ok = fclose(file) == 0 && ok;
+  return ok;
+}
+
+/**
+* A graph file mapped read-only into memory.
+*
+* Opening does no parsing and no copying: the header is checked and
+* CSRRangedGraph is pointed straight at the mapped arrays.  Only the deletion
+* overlay is allocated per process.
+*/
+class MappedGraphFile {
+  public:
+  /** The mapped graph, or null if no file is open. */
+  CSRRangedGraph *graph;
+  const GraphFileHeader *header;
+
+  MappedGraphFile() :
+      graph(nullptr),
+      header(nullptr),
+      mapping(nullptr),
+      length(0) {}
+
+  ~MappedGraphFile() {
+    close();
+  }
+
+  /**
+  * Maps a graph file.
+  *
+  * @return Whether the file exists and holds a valid graph of this version
+  * and byte order.
+  */
+  bool open(const char *path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        (std::uint64_t) info.st_size < sizeof(GraphFileHeader)) {
+      ::close(fd);
+      return false;
+    }
+    length = (std::size_t) info.st_size;
+    void *mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+      length = 0;
+      return false;
+    }
+    mapping = mapped;
+    header = static_cast<const GraphFileHeader *>(mapping);
+    if (!valid() || !validateContents()) {
+      close();
+      return false;
+    }
+    const char *base = static_cast<const char *>(mapping);
+    graph = new CSRRangedGraph(header->bottomVertex, header->topVertex,
+        reinterpret_cast<const std::uint64_t *>(base + header->offsetsStart),
+        reinterpret_cast<const CSRIncidence *>(base + header->adjacencyStart),
+        reinterpret_cast<const CSREndpoints *>(base + header->endpointsStart),
+        header->edges);
+    return true;
+  }
+
+  void close() {
+    delete graph;
+    graph = nullptr;
+    header = nullptr;
+    if (mapping != nullptr) {
+      munmap(mapping, length);
+    }
+    mapping = nullptr;
+    length = 0;
+  }
+
+  private:
+  void *mapping;
+  std::size_t length;
+
+  bool valid() {
+    if (memcmp(header->magic, GRAPH_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != GRAPH_FILE_VERSION || header->byteOrder != 1 ||
+        header->topVertex < header->bottomVertex ||
+        header->edges > 0xFFFFFFFFu) {
+      return false;
+    }
+    GraphFileHeader expected = graphFileHeader(header->bottomVertex,
+        header->topVertex, header->edges);
+    return header->vertices == expected.vertices &&
+        header->offsetsStart == expected.offsetsStart &&
+        header->adjacencyStart == expected.adjacencyStart &&
+        header->endpointsStart == expected.endpointsStart &&
+        header->fileSize == expected.fileSize && length >= expected.fileSize;
+  }
+
+  /**
+  * Checks the arrays themselves, which valid() only locates: offsets start at
+  * 0, never decrease and end at 2 * edges, every endpoint is a vertex of the
+  * range, and every incidence names an edge whose endpoints are its vertex
+  * and neighbor.  CSRRangedGraph indexes with all of these unchecked, so a
+  * corrupt or hostile file is turned away here rather than read out of
+  * bounds later.  Linear in the size of the file.
+  */
+  bool validateContents() {
+    const char *base = static_cast<const char *>(mapping);
+    const std::uint64_t *offsets =
+        reinterpret_cast<const std::uint64_t *>(base + header->offsetsStart);
+    const CSRIncidence *adjacency =
+        reinterpret_cast<const CSRIncidence *>(base + header->adjacencyStart);
+    const CSREndpoints *endpoints =
+        reinterpret_cast<const CSREndpoints *>(base + header->endpointsStart);
+    int bottom = header->bottomVertex;
+    int top = header->topVertex;
+    std::uint64_t edges = header->edges;
+    if (offsets[0] != 0 || offsets[header->vertices] != 2 * edges) {
+      return false;
+    }
+    for (std::uint64_t e = 0; e < edges; e++) {
+      const CSREndpoints &ends = endpoints[e];
+      if (ends.left < bottom || ends.left >= top || ends.right < bottom ||
+          ends.right >= top) {
+        return false;
+      }
+    }
+    for (std::uint64_t i = 0; i < header->vertices; i++) {
+      if (offsets[i + 1] < offsets[i]) {
+        return false;
+      }
+      int vertex = bottom + (int) i;
+      for (std::uint64_t a = offsets[i]; a < offsets[i + 1]; a++) {
+        const CSRIncidence &incidence = adjacency[a];
+        if (incidence.edge >= edges) {
+          return false;
+        }
+        const CSREndpoints &ends = endpoints[incidence.edge];
+        if (!(ends.left == vertex && ends.right == incidence.neighbor) &&
+            !(ends.right == vertex && ends.left == incidence.neighbor)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+};
+
+/**
+* Reads a text graph into an edge array.
+*
+* Two formats are understood, told apart line by line:
+*   DIMACS    - "c" comment lines, a "p edge <vertices> <edges>" line and
+*               "e <u> <v>" edge lines with vertices numbered from 1.
+*   Edge list - "<u> <v>" per line; lines starting with '#' or '%' are
+*               comments.
+*
+* @param bottom Set to the lowest vertex seen (1 for DIMACS).
+* @param top Set to the highest vertex seen plus one, or the declared vertex
+* count plus one for DIMACS.
+* @return Whether the file could be read and every line parsed.
+*/
+inline bool readTextGraph(const char *path, std::vector<CSREndpoints> &edges,
+    int &bottom, int &top) {
+  FILE *file = fopen(path, "r");
+  if (file == nullptr) {
+    return false;
+  }
+  struct stat info;
+  long size = fstat(fileno(file), &info) == 0 ? (long) info.st_size : 0;
+  long low = LONG_MAX;
+  long high = LONG_MIN;
+  long declared = -1;
+  bool ok = true;
+  //getline grows the buffer, so long comment lines are read whole.
+  char *line = nullptr;
+  std::size_t capacity = 0;
+  while (ok && getline(&line, &capacity, file) != -1) {
+    char *p = line;
+    while (*p == ' ' || *p == '\t') {
+      p++;
+    }
+    if (*p == '\n' || *p == '\r' || *p == 0 || *p == 'c' || *p == '#' ||
+        *p == '%') {
+      continue;
+    }
+    if (*p == 'p') {
+      char kind[32];
+      long n, m;
+      ok = sscanf(p + 1, "%31s %ld %ld", kind, &n, &m) == 3 && n >= 0 &&
+          n < INT_MAX && m >= 0;
+      if (ok) {
+        declared = n;
+        //Every edge line takes at least four bytes, so a larger m is a lie.
+        edges.reserve((std::size_t) (m < size / 4 ? m : size / 4));
+      }
+      continue;
+    }
+    if (*p == 'e') {
+      p++;
+    }
+    char *end;
+    long u = strtol(p, &end, 10);
+    ok = end != p;
+    p = end;
+    long v = strtol(p, &end, 10);
+    //INT_MAX is excluded from both, since top is the highest vertex plus one.
+    ok = ok && end != p && u >= INT_MIN && u < INT_MAX && v >= INT_MIN &&
+        v < INT_MAX;
+    //Anything after the second endpoint, such as a weight, follows a blank.
+    ok = ok && (*end == ' ' || *end == '\t' || *end == '\r' ||
+        *end == '\n' || *end == 0);
+    if (ok) {
+      edges.push_back({(int) u, (int) v});
+      low = u < low ? u : low;
+      low = v < low ? v : low;
+      high = u > high ? u : high;
+      high = v > high ? v : high;
+    }
+  }
+  free(line);
+  fclose(file);
+  if (declared >= 0) {
+    ok = ok && (edges.empty() || (low >= 1 && high <= declared));
+    bottom = 1;
+    top = (int) declared + 1;
+  } else if (edges.empty()) {
+    bottom = 0;
+    top = 0;
+  } else {
+    bottom = (int) low;
+    top = (int) high + 1;
+  }
+  return ok;
+}
+
+/**
+* Converts a text edge list or DIMACS file to the binary format.
+*
+* @return Whether both reading and writing succeeded.
+*/
+inline bool convertTextGraph(const char *textPath, const char *binaryPath) {
+  std::vector<CSREndpoints> edges;
+  int bottom, top;
+  if (!readTextGraph(textPath, edges, bottom, top)) {
+    return false;
+  }
+  CSRRangedGraph graph(bottom, top, edges.data(), edges.size());
+  return writeGraphFile(binaryPath, graph);
+}
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef INCREMENTAL_VERTEX_COVER__
+#define INCREMENTAL_VERTEX_COVER__
+
+#include <vector>
+
+#include "RangedGraph.h"
+
+/**
+* Vertex cover kept up to date as edges come and go on an
+* EntangledRangedGraph.
+*
+* The cover is both ends of a maximal matching, which makes it a
+* 2-approximation at all times.  Matching is kept maximal as follows:
+*   - An inserted edge is matched if both its ends are free.  O(1).
+*   - Deleting an unmatched edge changes nothing.  O(1).
+*   - Deleting a matched edge frees both ends, and each is rematched to the
+*     first free neighbor in its adjacency, if any.  O(degree).
+* Removing a vertex skips its own rematching until the last of its edges is
+* gone, so it costs O(degree) per neighbor freed rather than O(degree^2).
+*
+* solution and value mirror the VertexCover fields; solution is unordered.
+*
+* Entangles itself on construction and disentangles on destruction, so
+* either the cover or the graph may be destroyed first.
+*/
+template<class V, class E>
+class IncrementalVertexCover : public RangedGraphEntanglement<V, E> {
+  public:
+  std::vector<int> solution;
+  int value;
+
+  /**
+  * Greedily matches the graph's current edges, then follows it.
+  */
+  IncrementalVertexCover(EntangledRangedGraph<V, E> *graph) :
+      value(0),
+      bottomVertex(graph->bottomBucket),
+      mate(graph->buckets, nullptr),
+      index(graph->buckets, (int) NOT_IN_COVER),
+      removingVertex(graph->bottomBucket - 1) {
+    for (int v = graph->bottomBucket; v <= graph->topBucket; v++) {
+      rematch(*graph, v);
+    }
+    this->entangle(graph);
+  }
+
+  ~IncrementalVertexCover() {
+    if (this->graph != nullptr) {
+      this->disentangle();
+    }
+  }
+
+  bool inCover(int vertex) {
+    return index[vertex - bottomVertex] != NOT_IN_COVER;
+  }
+
+  /**
+  * The matched edge covering a vertex, or null if the vertex is free.
+  */
+  Edge<V, E> *matchedEdge(int vertex) {
+    return mate[vertex - bottomVertex];
+  }
+
+  void afterAddEdge(const Edge<V, E> *edge) {
+    int left = this->graph->keyOf(edge->left);
+    int right = this->graph->keyOf(edge->right);
+    if (matchedEdge(left) == nullptr && matchedEdge(right) == nullptr) {
+      match(const_cast<Edge<V, E> *>(edge), left, right);
+    }
+  }
+
+  /**
+  * A matched edge is unmatched here, while its ends can still be read; they
+  * are rematched once it is gone.
+  */
+  void beforeRemoveEdge(const Edge<V, E> *edge) {
+    freedLeft = freedRight = bottomVertex - 1;
+    int left = this->graph->keyOf(edge->left);
+    if (matchedEdge(left) != edge) {
+      return;
+    }
+    freedLeft = left;
+    freedRight = this->graph->keyOf(edge->right);
+    unmatch(freedLeft);
+    unmatch(freedRight);
+  }
+
+  void afterRemoveEdge() {
+    if (freedLeft < bottomVertex) {
+      return;
+    }
+    if (freedLeft != removingVertex) {
+      rematch(*this->graph, freedLeft);
+    }
+    if (freedRight != removingVertex) {
+      rematch(*this->graph, freedRight);
+    }
+  }
+
+  void beforeRemoveVertex(int vertex) {
+    removingVertex = vertex;
+  }
+
+  void afterRemoveVertex() {
+    removingVertex = bottomVertex - 1;
+  }
+
+  private:
+  static const int NOT_IN_COVER = -1;
+
+  int bottomVertex;
+  /** Each vertex's matched edge, or null. */
+  std::vector<Edge<V, E> *> mate;
+  /** Each vertex's index in solution, or NOT_IN_COVER. */
+  std::vector<int> index;
+  /** Ends of the matched edge being removed, or below bottomVertex. */
+  int freedLeft;
+  int freedRight;
+  /** Vertex whose edges are all being removed, or below bottomVertex. */
+  int removingVertex;
+
+  void match(Edge<V, E> *edge, int left, int right) {
+    mate[left - bottomVertex] = edge;
+    mate[right - bottomVertex] = edge;
+    add(left);
+    if (right != left) {
+      add(right);
+    }
+  }
+
+  void unmatch(int vertex) {
+    if (mate[vertex - bottomVertex] == nullptr) {
+      return;
+    }
+    mate[vertex - bottomVertex] = nullptr;
+    //Swap the last vertex of the solution into the hole.
+    int i = index[vertex - bottomVertex];
+    int last = solution.back();
+    solution[i] = last;
+    index[last - bottomVertex] = i;
+    solution.pop_back();
+    index[vertex - bottomVertex] = NOT_IN_COVER;
+    value--;
+  }
+
+  void add(int vertex) {
+    index[vertex - bottomVertex] = (int) solution.size();
+    solution.push_back(vertex);
+    value++;
+  }
+
+  /**
+  * Matches a free vertex to its first free neighbor.  A self-loop counts as
+  * a free neighbor, since the vertex must be in the cover either way.  The
+  * vertex being removed does not count: its edges are about to go.
+  */
+  void rematch(RangedGraph<V, E> &graph, int vertex) {
+    if (matchedEdge(vertex) != nullptr) {
+      return;
+    }
+    Vertex<V, E> *v = graph.bucket(vertex);
+    for (Position<Edge<V, E> *> *p = v->first(); p != v->end(); p = p->next) {
+      Edge<V, E> *edge = p->value;
+      int neighbor = graph.keyOf(edge->neighbor(p));
+      if (matchedEdge(neighbor) == nullptr && neighbor != removingVertex) {
+        match(edge, vertex, neighbor);
+        return;
+      }
+    }
+  }
+};
+
+#endif
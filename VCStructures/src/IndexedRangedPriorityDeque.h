@@ -0,0 +1,272 @@
+#ifndef INDEXED_RANGED_PDEQUE__
+#define INDEXED_RANGED_PDEQUE__
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "OccupancyBitmap.h"
+
+/**
+* Element ids that are already the indices 0..elements-1.
+*/
+struct IdentityIndex {
+  std::size_t index(int element) const {
+    return (std::size_t) element;
+  }
+
+  int element(std::size_t index) const {
+    return (int) index;
+  }
+};
+
+/**
+* Element ids forming a contiguous range starting at bottom, such as the
+* vertices of a RangedGraph starting at bottomVertex.
+*/
+struct OffsetIndex {
+  int bottom;
+
+  OffsetIndex(int bottom = 0) : bottom(bottom) {}
+
+  std::size_t index(int element) const {
+    return (std::size_t) ((long long) element - bottom);
+  }
+
+  int element(std::size_t index) const {
+    return bottom + (int) index;
+  }
+};
+
+/**
+* Adaptable priority deque over a fixed set of elements, such as the
+* vertices of a graph.
+*
+* The elements are values of type T that I maps one to one onto the indices
+* 0..elements-1: I has index(T), giving an element's index, and
+* element(index), giving it back.  The default takes int ids that are their
+* own index; OffsetIndex takes any contiguous range of ids.
+*
+* Every element owns one node for the life of the deque, found at a fixed
+* index, so the element itself is the handle: there are no Positions to
+* store, refresh or free.  Insertion, key changes, elimination, key lookup
+* and both pops are O(1) and never allocate after construction.  An
+* eliminated or popped element can be inserted again with any key.
+*
+* Like CompactRangedBuckets, nodes link to each other with 32 bit indices
+* within a single array whose first `buckets` slots are circular bucket
+* sentinels, and an OccupancyBitmap finds the extreme non-empty buckets.
+*/
+template<typename T = int, class I = IdentityIndex>
+class IndexedRangedPriorityDeque {
+  public:
+  typedef std::uint32_t Index;
+
+  /** Key of an element that is not queued. */
+  static const int NOT_QUEUED = -2147483647 - 1;
+
+  struct Node {
+    int key;
+    Index next;
+    Index previous;
+  };
+
+  /** Maps elements to their node and back. */
+  I indexer;
+  /** Bucket sentinels, then one node per element. */
+  std::vector<Node> nodes;
+  OccupancyBitmap occupied;
+
+  /** Index of the top valid bucket. */
+  int topBucket;
+  /** Index of the bottom valid bucket. */
+  int bottomBucket;
+  /** Number of buckets. */
+  std::size_t buckets;
+  /** Number of queued elements. */
+  std::size_t size;
+
+  /**
+  * @param bottom The lowest valid key.
+  * @param top The highest valid key plus one.
+  * @param elements Number of elements; none are queued initially.
+  * @param indexer Maps the elements onto 0..elements-1.
+  */
+  IndexedRangedPriorityDeque(int bottom, int top, std::size_t elements,
+      I indexer = I()) :
+      indexer(indexer),
+      nodes(top - bottom + elements),
+      occupied(top - bottom),
+      topBucket(top - 1),
+      bottomBucket(bottom),
+      buckets(top - bottom),
+      size(0) {
+    for (std::size_t i = 0; i < buckets; i++) {
+      nodes[i].next = (Index) i;
+      nodes[i].previous = (Index) i;
+    }
+    for (std::size_t i = buckets; i < nodes.size(); i++) {
+      nodes[i].key = NOT_QUEUED;
+    }
+  }
+
+  void error() {
+    exit(1);
+  }
+
+#ifndef NO_CHECKS
+#define CHECK_INDEXED_BOUNDS(bucket) { \
+  if (bucket < bottomBucket || bucket > topBucket) error(); \
+}
+#define CHECK_INDEXED_ELEMENT(element) { \
+  if (indexer.index(element) >= nodes.size() - buckets) error(); \
+}
+#define CHECK_INDEXED_QUEUED(element, queued) { \
+  if ((node(element).key != NOT_QUEUED) != queued) error(); \
+}
+#define CHECK_INDEXED_EMPTY if (size == 0) error();
+#else
+#define CHECK_INDEXED_BOUNDS(bucket)
+#define CHECK_INDEXED_ELEMENT(element)
+#define CHECK_INDEXED_QUEUED(element, queued)
+#define CHECK_INDEXED_EMPTY
+#endif
+
+  bool contains(T element) {
+    CHECK_INDEXED_ELEMENT(element)
+    return node(element).key != NOT_QUEUED;
+  }
+
+  /**
+  * Current key of an element, or NOT_QUEUED.
+  */
+  int keyOf(T element) {
+    CHECK_INDEXED_ELEMENT(element)
+    return node(element).key;
+  }
+
+  /**
+  * Queues an element that is not already queued.
+  */
+  void add(int key, T element) {
+    CHECK_INDEXED_ELEMENT(element)
+    CHECK_INDEXED_BOUNDS(key)
+    CHECK_INDEXED_QUEUED(element, false)
+    link(element, key);
+    size++;
+  }
+
+  /**
+  * Changes the key of a queued element.
+  */
+  void adapt(T element, int key) {
+    CHECK_INDEXED_ELEMENT(element)
+    CHECK_INDEXED_BOUNDS(key)
+    CHECK_INDEXED_QUEUED(element, true)
+    unlink(element);
+    link(element, key);
+  }
+
+  /**
+  * Removes a queued element.  Its node stays reserved for it.
+  */
+  void eliminate(T element) {
+    CHECK_INDEXED_ELEMENT(element)
+    CHECK_INDEXED_QUEUED(element, true)
+    unlink(element);
+    size--;
+  }
+
+  /**
+  * Key of the highest non-empty bucket.  Only meaningful when not empty.
+  */
+  int topKey() {
+    return bottomBucket + (int) occupied.previous(buckets - 1);
+  }
+
+  /**
+  * Key of the lowest non-empty bucket.  Only meaningful when not empty.
+  */
+  int bottomKey() {
+    return bottomBucket + (int) occupied.next(0);
+  }
+
+  T peepTop() {
+    CHECK_INDEXED_EMPTY
+    return element(nodes[sentinel(topKey())].next);
+  }
+
+  T peepBottom() {
+    CHECK_INDEXED_EMPTY
+    return element(nodes[sentinel(bottomKey())].previous);
+  }
+
+  T popTop() {
+    T top = peepTop();
+    eliminate(top);
+    return top;
+  }
+
+  T popBottom() {
+    T bottom = peepBottom();
+    eliminate(bottom);
+    return bottom;
+  }
+
+  /**
+  * Dequeues every element in O(buckets + elements).
+  */
+  void clear() {
+    for (std::size_t i = 0; i < buckets; i++) {
+      nodes[i].next = (Index) i;
+      nodes[i].previous = (Index) i;
+    }
+    for (std::size_t i = buckets; i < nodes.size(); i++) {
+      nodes[i].key = NOT_QUEUED;
+    }
+    occupied.reset();
+    size = 0;
+  }
+
+  private:
+  Node &node(T element) {
+    return nodes[buckets + indexer.index(element)];
+  }
+
+  T element(Index index) {
+    return indexer.element(index - buckets);
+  }
+
+  Index sentinel(int key) {
+    return (Index) (key - bottomBucket);
+  }
+
+  void link(T element, int key) {
+    Index i = (Index) (buckets + indexer.index(element));
+    Index s = sentinel(key);
+    Index tail = nodes[s].previous;
+    if (tail == s) {
+      occupied.set(s);
+    }
+    nodes[i].key = key;
+    nodes[i].previous = tail;
+    nodes[i].next = s;
+    nodes[tail].next = i;
+    nodes[s].previous = i;
+  }
+
+  void unlink(T element) {
+    Node &n = node(element);
+    nodes[n.previous].next = n.next;
+    nodes[n.next].previous = n.previous;
+    Index s = sentinel(n.key);
+    if (nodes[s].next == s) {
+      occupied.clear(s);
+    }
+    n.key = NOT_QUEUED;
+  }
+};
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef OCCUPANCY_BITMAP__
+#define OCCUPANCY_BITMAP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+* Hierarchical bitmap over a fixed range of indices.
+*
+* Level 0 holds one bit per index.  Each higher level holds one bit per word
+* of the level below it, set whenever that word is non-zero, so the top level
+* is a single word.  Finding the nearest set bit in either direction looks at
+* one word per level with a count-leading/trailing-zeros instruction, which
+* is at most four words for a range of 16 million.
+*
+* Meant to track which buckets of a RangedBuckets are non-empty so that
+* priority deque pops can jump straight to the next occupied bucket.
+*/
+class OccupancyBitmap {
+  public:
+  typedef std::uint64_t Word;
+
+  /** Returned by searches that find nothing. */
+  static const std::size_t NONE = (std::size_t) -1;
+
+  /** levels[0] is the leaf level; levels.back() is a single word. */
+  std::vector<std::vector<Word>> levels;
+  /** Number of indices covered. */
+  std::size_t bits;
+
+  OccupancyBitmap(std::size_t bits = 0) : bits(bits) {
+    std::size_t count = bits;
+    do {
+      count = (count + 63) / 64;
+      levels.push_back(std::vector<Word>(count == 0 ? 1 : count, 0));
+    } while (count > 1);
+  }
+
+  bool test(std::size_t index) const {
+    return (levels[0][index >> 6] >> (index & 63)) & 1;
+  }
+
+  void set(std::size_t index) {
+    for (std::size_t level = 0; level < levels.size(); level++) {
+      Word &word = levels[level][index >> 6];
+      bool wasEmpty = word == 0;
+      word |= Word(1) << (index & 63);
+      if (!wasEmpty) {
+        return;
+      }
+      index >>= 6;
+    }
+  }
+
+  void clear(std::size_t index) {
+    for (std::size_t level = 0; level < levels.size(); level++) {
+      Word &word = levels[level][index >> 6];
+      word &= ~(Word(1) << (index & 63));
+      if (word != 0) {
+        return;
+      }
+      index >>= 6;
+    }
+  }
+
+  /**
+  * Extends the range to newBits indices, keeping every bit already set.
+  * Costs O(new words), plus a pass over the old top level if a level has to
+  * be added above it.
+  */
+  void grow(std::size_t newBits) {
+    if (newBits <= bits) {
+      return;
+    }
+    bits = newBits;
+    std::size_t count = newBits;
+    std::size_t level = 0;
+    do {
+      count = (count + 63) / 64;
+      if (level < levels.size()) {
+        levels[level].resize(count == 0 ? 1 : count, 0);
+      } else {
+        //New top level: one bit for each non-zero word of the old top.
+        std::vector<Word> above(count, 0);
+        std::vector<Word> &below = levels[level - 1];
+        for (std::size_t w = 0; w < below.size(); w++) {
+          if (below[w] != 0) {
+            above[w >> 6] |= Word(1) << (w & 63);
+          }
+        }
+        levels.push_back(above);
+      }
+      level++;
+    } while (count > 1);
+  }
+
+  /**
+  * Clears every bit.
+  */
+  void reset() {
+    for (std::vector<Word> &level : levels) {
+      for (Word &word : level) {
+        word = 0;
+      }
+    }
+  }
+
+  /**
+  * @return The lowest set index that is at least index, or NONE.
+  */
+  std::size_t next(std::size_t index) const {
+    if (index >= bits) {
+      return NONE;
+    }
+    std::size_t level = 0;
+    //Climb until a word has a set bit at or above the current position.
+    for (;;) {
+      std::size_t w = index >> 6;
+      if (w >= levels[level].size()) {
+        return NONE;
+      }
+      Word masked = levels[level][w] & (~Word(0) << (index & 63));
+      if (masked != 0) {
+        index = (w << 6) + lowest(masked);
+        break;
+      }
+      if (++level == levels.size()) {
+        return NONE;
+      }
+      index = w + 1;
+    }
+    //Descend, taking the lowest set bit of each word on the way down.
+    while (level-- > 0) {
+      index = (index << 6) + lowest(levels[level][index]);
+    }
+    return index;
+  }
+
+  /**
+  * @return The highest set index that is at most index, or NONE.
+  */
+  std::size_t previous(std::size_t index) const {
+    if (bits == 0) {
+      return NONE;
+    }
+    if (index >= bits) {
+      index = bits - 1;
+    }
+    std::size_t level = 0;
+    for (;;) {
+      std::size_t w = index >> 6;
+      Word masked = levels[level][w] & (~Word(0) >> (63 - (index & 63)));
+      if (masked != 0) {
+        index = (w << 6) + highest(masked);
+        break;
+      }
+      if (++level == levels.size() || w == 0) {
+        return NONE;
+      }
+      index = w - 1;
+    }
+    while (level-- > 0) {
+      index = (index << 6) + highest(levels[level][index]);
+    }
+    return index;
+  }
+
+  private:
+  static std::size_t lowest(Word word) {
+    return __builtin_ctzll(word);
+  }
+
+  static std::size_t highest(Word word) {
+    return 63 - __builtin_clzll(word);
+  }
+
+};
+
+#endif
@@ -0,0 +1,531 @@
+#ifndef PARALLEL_GRAPH_PARSER__
+#define PARALLEL_GRAPH_PARSER__
+
+#include <stdio.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "CSRRangedGraph.h"
+#include "WorkerPool.h"
+
+/**
+* Multi-threaded text graph reader that builds a CSRRangedGraph directly.
+*
+* The file is mapped and cut into one chunk per thread, with each cut moved
+* forward to the next line start.  Every pass runs all chunks in parallel on
+* a WorkerPool started once per parse:
+*   1. Count edges per chunk and the lowest and highest vertex seen.
+*   2. Count every vertex's degree with relaxed atomic increments.
+*   3. Scatter each edge into the final adjacency through atomic row cursors,
+*      and into the endpoint array at its chunk's prefix-summed base.
+* When the header declares the vertex range (DIMACS and METIS), passes one
+* and two are one pass that also checks each edge against the range, so the
+* text is tokenised twice.  METIS adds a line count before them, which only
+* looks for newlines.  No array of parsed edges is ever built; the text is
+* simply parsed again, which is cheap next to the memory traffic of the
+* scatter.
+*
+* Edge ids follow file order, as they would through readTextGraph, but the
+* order of entries within one vertex's adjacency depends on thread timing.
+*
+* Supported formats:
+*   EDGE_LIST - "<u> <v>" per line, '#' and '%' comment lines.
+*   DIMACS    - "c" comments, "p edge <n> <m>", "e <u> <v>" with 1-based ids.
+*   METIS     - "%" comments, a "<n> <m> [fmt [ncon]]" header, then line i
+*               lists the neighbors of vertex i (1-based).  Each edge is listed
+*               from both ends and kept once.  Vertex sizes, vertex weights
+*               and edge weights are skipped; a fmt other than three 0 or 1
+*               digits is rejected, as is a vertex line count other than n.
+*
+* parse keeps no state in the parser, so one parser may serve several
+* threads at once.
+*/
+class ParallelGraphParser {
+  public:
+  enum Format { AUTO, EDGE_LIST, DIMACS, METIS };
+
+  /** Threads used by each pass, the calling thread included. */
+  unsigned threads;
+
+  ParallelGraphParser(unsigned threads = 0) :
+      threads(threads != 0 ? threads :
+          (std::thread::hardware_concurrency() != 0 ?
+              std::thread::hardware_concurrency() : 1)) {}
+
+  /**
+  * Parses a text graph file.
+  *
+  * AUTO picks METIS for ".graph" and ".metis" files, DIMACS when the first
+  * non-blank line starts with 'c' or 'p', and EDGE_LIST otherwise.
+  *
+  * @return The graph, owned by the caller, or null if the file could not be
+  * read or did not parse.
+  */
+  CSRRangedGraph *parse(const char *path, Format format = AUTO) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+      ::close(fd);
+      return nullptr;
+    }
+    std::size_t length = (std::size_t) info.st_size;
+    void *mapped = nullptr;
+    if (length > 0) {
+      mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+      return nullptr;
+    }
+    const char *text = static_cast<const char *>(mapped);
+    if (format == AUTO) {
+      format = detect(path, text, text + length);
+    }
+    CSRRangedGraph *graph = parse(text, text + length, format);
+    if (mapped != nullptr) {
+      munmap(mapped, length);
+    }
+    return graph;
+  }
+
+  /**
+  * Parses text already in memory.  AUTO is treated as EDGE_LIST.
+  */
+  CSRRangedGraph *parse(const char *begin, const char *end, Format format) {
+    Header header;
+    if (!readHeader(begin, end, format, header)) {
+      return nullptr;
+    }
+    std::vector<Chunk> chunks = split(header.body, end);
+    WorkerPool pool((unsigned) (chunks.empty() ? 1 : chunks.size()));
+    if (format == METIS) {
+      run(pool, chunks, [&](Chunk &chunk) {
+        countMetisLines(chunk);
+      });
+      long line = 1;
+      for (Chunk &chunk : chunks) {
+        chunk.firstVertex = line;
+        line += chunk.vertexLines;
+      }
+      if (line - 1 != header.vertices) {
+        return nullptr;
+      }
+    }
+
+    long bottom, top;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> cursor;
+    if (header.vertices >= 0) {
+      //Passes one and two at once: the range is known up front.
+      bottom = 1;
+      top = header.vertices + 1;
+      cursor.reset(new std::atomic<std::uint64_t>[top - bottom + 1]());
+      run(pool, chunks, [&](Chunk &chunk) {
+        scan(chunk, header, format, [&](long u, long v) {
+          if (u < bottom || u >= top || v < bottom || v >= top) {
+            chunk.ok = false;
+            return false;
+          }
+          chunk.edges++;
+          cursor[u - bottom].fetch_add(1, std::memory_order_relaxed);
+          cursor[v - bottom].fetch_add(1, std::memory_order_relaxed);
+          return true;
+        });
+      });
+    } else {
+      //Pass one: sizes and vertex range.
+      run(pool, chunks, [&](Chunk &chunk) {
+        scan(chunk, header, format, [&](long u, long v) {
+          chunk.edges++;
+          chunk.low = u < chunk.low ? u : chunk.low;
+          chunk.low = v < chunk.low ? v : chunk.low;
+          chunk.high = u > chunk.high ? u : chunk.high;
+          chunk.high = v > chunk.high ? v : chunk.high;
+          return true;
+        });
+      });
+      long low = LONG_MAX;
+      long high = LONG_MIN;
+      for (Chunk &chunk : chunks) {
+        low = chunk.low < low ? chunk.low : low;
+        high = chunk.high > high ? chunk.high : high;
+      }
+      bottom = low <= high ? low : 0;
+      top = low <= high ? high + 1 : 0;
+    }
+    std::size_t edges = 0;
+    for (Chunk &chunk : chunks) {
+      if (!chunk.ok) {
+        return nullptr;
+      }
+      chunk.base = edges;
+      edges += chunk.edges;
+    }
+    if (bottom < INT_MIN || top > INT_MAX || edges > 0xFFFFFFFFu) {
+      return nullptr;
+    }
+    std::size_t vertices = (std::size_t) (top - bottom);
+
+    if (header.vertices < 0) {
+      //Pass two: degrees.
+      cursor.reset(new std::atomic<std::uint64_t>[vertices + 1]());
+      run(pool, chunks, [&](Chunk &chunk) {
+        scan(chunk, header, format, [&](long u, long v) {
+          cursor[u - bottom].fetch_add(1, std::memory_order_relaxed);
+          cursor[v - bottom].fetch_add(1, std::memory_order_relaxed);
+          return true;
+        });
+      });
+    }
+    std::vector<std::uint64_t> offsets(vertices + 1);
+    std::uint64_t running = 0;
+    for (std::size_t i = 0; i < vertices; i++) {
+      std::uint64_t degree = cursor[i].load(std::memory_order_relaxed);
+      offsets[i] = running;
+      cursor[i].store(running, std::memory_order_relaxed);
+      running += degree;
+    }
+    offsets[vertices] = running;
+
+    //Pass three: scatter.
+    std::vector<CSRIncidence> adjacency(2 * edges);
+    std::vector<CSREndpoints> endpoints(edges);
+    run(pool, chunks, [&](Chunk &chunk) {
+      std::size_t id = chunk.base;
+      scan(chunk, header, format, [&](long u, long v) {
+        endpoints[id] = {(int) u, (int) v};
+        adjacency[cursor[u - bottom].fetch_add(1, std::memory_order_relaxed)]
+            = {(int) v, (std::uint32_t) id};
+        adjacency[cursor[v - bottom].fetch_add(1, std::memory_order_relaxed)]
+            = {(int) u, (std::uint32_t) id};
+        id++;
+        return true;
+      });
+    });
+
+    return new CSRRangedGraph((int) bottom, (int) top, std::move(offsets),
+        std::move(adjacency), std::move(endpoints));
+  }
+
+  private:
+  struct Header {
+    /** Where edge lines start. */
+    const char *body;
+    /** Declared vertex count, or -1 if the format has none. */
+    long vertices;
+    /** METIS: whether lines start with a vertex size. */
+    bool vertexSizes;
+    /** METIS: whether lines start with vertex weights, and how many. */
+    int vertexWeights;
+    /** METIS: whether each neighbor is followed by an edge weight. */
+    bool edgeWeights;
+  };
+
+  struct Chunk {
+    const char *begin;
+    const char *end;
+    bool ok;
+    std::size_t edges;
+    long low;
+    long high;
+    /** METIS: number of vertex lines in the chunk. */
+    long vertexLines;
+    /** METIS: vertex of the chunk's first line. */
+    long firstVertex;
+    /** Id of the chunk's first edge. */
+    std::size_t base;
+  };
+
+  static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  /** Largest magnitude number accepts, that of INT_MIN. */
+  static const unsigned long long NUMBER_LIMIT = 2147483648ULL;
+
+  /**
+  * Branch-light unsigned parse: the digit test is a single unsigned compare
+  * and the loop has no other conditions.  A magnitude beyond NUMBER_LIMIT
+  * is not found, and leaves p at the number, so that the caller sees text
+  * left on the line rather than a wrapped value.
+  */
+  static const char *number(const char *p, const char *end, long &value,
+      bool &found) {
+    while (p < end && isBlank(*p)) {
+      p++;
+    }
+    const char *number = p;
+    bool negative = p < end && *p == '-';
+    p += negative;
+    const char *start = p;
+    unsigned long long v = 0;
+    unsigned digit;
+    while (p < end && (digit = (unsigned) (*p - '0')) < 10) {
+      v = v * 10 + digit;
+      //Saturate, so that any number of digits cannot wrap.
+      v = v > NUMBER_LIMIT ? NUMBER_LIMIT + 1 : v;
+      p++;
+    }
+    if (v > NUMBER_LIMIT) {
+      found = false;
+      return number;
+    }
+    found = p != start;
+    value = negative ? -(long) v : (long) v;
+    return p;
+  }
+
+  /**
+  * Whether only blanks remain before stop, as after the last number of a
+  * line.
+  */
+  static bool restIsBlank(const char *p, const char *stop) {
+    while (p < stop && isBlank(*p)) {
+      p++;
+    }
+    return p == stop;
+  }
+
+  static const char *lineEnd(const char *p, const char *end) {
+    const char *newline = static_cast<const char *>(
+        memchr(p, '\n', end - p));
+    return newline != nullptr ? newline : end;
+  }
+
+  static Format detect(const char *path, const char *p, const char *end) {
+    const char *dot = strrchr(path, '.');
+    if (dot != nullptr && (strcmp(dot, ".graph") == 0 ||
+        strcmp(dot, ".metis") == 0)) {
+      return METIS;
+    }
+    while (p < end && (isBlank(*p) || *p == '\n')) {
+      p++;
+    }
+    return p < end && (*p == 'c' || *p == 'p') ? DIMACS : EDGE_LIST;
+  }
+
+  /**
+  * Reads the format's header on the calling thread and finds the body.
+  */
+  bool readHeader(const char *p, const char *end, Format format,
+      Header &header) {
+    header.body = p;
+    header.vertices = -1;
+    header.vertexSizes = false;
+    header.vertexWeights = 0;
+    header.edgeWeights = false;
+    if (format == DIMACS) {
+      //The problem line comes before any edge line.
+      for (const char *line = p; line < end; line = lineEnd(line, end) + 1) {
+        const char *q = line;
+        while (q < end && isBlank(*q)) {
+          q++;
+        }
+        if (q < end && *q == 'p') {
+          while (q < end && *q != '\n' && (*q < '0' || *q > '9')) {
+            q++;
+          }
+          bool found;
+          number(q, end, header.vertices, found);
+          return found && header.vertices >= 0 && header.vertices < INT_MAX;
+        }
+        if (q < end && *q == 'e') {
+          return false;
+        }
+      }
+      return false;
+    }
+    if (format == METIS) {
+      for (const char *line = p; line < end; line = lineEnd(line, end) + 1) {
+        if (*line == '%') {
+          continue;
+        }
+        long values[4];
+        int count = 0;
+        const char *q = line;
+        const char *stop = lineEnd(line, end);
+        bool found = true;
+        while (count < 4) {
+          q = number(q, stop, values[count], found);
+          if (!found) {
+            break;
+          }
+          count++;
+        }
+        if (count < 2 || values[0] < 0 || values[0] >= INT_MAX) {
+          return false;
+        }
+        header.vertices = values[0];
+        long fmt = count > 2 ? values[2] : 0;
+        //fmt is up to three digits, each 0 or 1: sizes, weights, edge weights.
+        if (fmt < 0 || fmt > 111 || fmt % 10 > 1 || (fmt / 10) % 10 > 1 ||
+            fmt / 100 > 1) {
+          return false;
+        }
+        long constraints = count > 3 ? values[3] : 1;
+        if (constraints < 1 || constraints > INT_MAX) {
+          return false;
+        }
+        header.edgeWeights = fmt % 10 == 1;
+        header.vertexWeights = (fmt / 10) % 10 == 1 ? (int) constraints : 0;
+        header.vertexSizes = fmt / 100 == 1;
+        header.body = stop < end ? stop + 1 : end;
+        return true;
+      }
+      return false;
+    }
+    return true;
+  }
+
+  /**
+  * Cuts [p, end) into one chunk per thread, on line starts.
+  */
+  std::vector<Chunk> split(const char *p, const char *end) const {
+    std::vector<Chunk> chunks;
+    std::size_t length = end - p;
+    const char *begin = p;
+    for (unsigned i = 1; i <= threads && begin < end; i++) {
+      const char *cut = i == threads ? end : p + length * i / threads;
+      if (cut < begin) {
+        cut = begin;
+      }
+      if (cut < end) {
+        cut = lineEnd(cut, end);
+        cut = cut < end ? cut + 1 : end;
+      }
+      if (cut > begin) {
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = cut;
+        chunk.ok = true;
+        chunk.edges = 0;
+        chunk.low = LONG_MAX;
+        chunk.high = LONG_MIN;
+        chunk.vertexLines = 0;
+        chunk.firstVertex = 0;
+        chunk.base = 0;
+        chunks.push_back(chunk);
+      }
+      begin = cut;
+    }
+    return chunks;
+  }
+
+  /**
+  * Runs work on every chunk, one chunk per thread of the pool.
+  */
+  template<class F>
+  static void run(WorkerPool &pool, std::vector<Chunk> &chunks, F work) {
+    auto job = [&](unsigned index) {
+      if (index < chunks.size()) {
+        work(chunks[index]);
+      }
+    };
+    pool.run(job);
+  }
+
+  /**
+  * Calls onEdge(u, v) for every edge in a chunk, in file order, until it
+  * returns false.  Clears chunk.ok on a malformed line.
+  */
+  template<class F>
+  static void scan(Chunk &chunk, const Header &header, Format format,
+      F onEdge) {
+    if (format == METIS) {
+      scanMetis(chunk, header, onEdge);
+      return;
+    }
+    const char *end = chunk.end;
+    for (const char *p = chunk.begin; p < end;) {
+      const char *stop = lineEnd(p, end);
+      while (p < stop && isBlank(*p)) {
+        p++;
+      }
+      if (p < stop && *p != 'c' && *p != 'p' && *p != '#' && *p != '%') {
+        p += *p == 'e';
+        long u, v;
+        bool foundU, foundV;
+        p = number(p, stop, u, foundU);
+        p = number(p, stop, v, foundV);
+        //A third column, such as a weight, must be set off by a blank.
+        if (!foundU || !foundV || (p < stop && !isBlank(*p))) {
+          chunk.ok = false;
+          return;
+        }
+        if (!onEdge(u, v)) {
+          return;
+        }
+      }
+      p = stop + 1;
+    }
+  }
+
+  /**
+  * METIS: counts the vertex lines of a chunk so that each chunk can learn
+  * the vertex its first line belongs to.
+  */
+  static void countMetisLines(Chunk &chunk) {
+    const char *end = chunk.end;
+    for (const char *p = chunk.begin; p < end; p = lineEnd(p, end) + 1) {
+      if (*p != '%') {
+        chunk.vertexLines++;
+      }
+    }
+  }
+
+  template<class F>
+  static void scanMetis(Chunk &chunk, const Header &header, F onEdge) {
+    long vertex = chunk.firstVertex;
+    const char *end = chunk.end;
+    for (const char *p = chunk.begin; p < end;) {
+      const char *stop = lineEnd(p, end);
+      if (*p == '%') {
+        p = stop + 1;
+        continue;
+      }
+      long value;
+      bool found = true;
+      int skipped = header.vertexSizes + header.vertexWeights;
+      for (int i = 0; i < skipped && found; i++) {
+        p = number(p, stop, value, found);
+      }
+      while (found) {
+        p = number(p, stop, value, found);
+        if (!found) {
+          break;
+        }
+        //Each edge is listed from both ends; keep the one from the lower.
+        if (vertex <= value && !onEdge(vertex, value)) {
+          return;
+        }
+        if (header.edgeWeights) {
+          long weight;
+          p = number(p, stop, weight, found);
+        }
+      }
+      if (!restIsBlank(p, stop)) {
+        chunk.ok = false;
+        return;
+      }
+      p = stop + 1;
+      vertex++;
+    }
+  }
+
+};
+
+#endif
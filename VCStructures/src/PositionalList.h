@@ -1,84 +1,260 @@
 #ifndef POSITIONAL_LIST__
 #define POSITIONAL_LIST__
 
-#ifndef NO_CHECKS
-#include <stdlib.h>
-#endif
-
+#include <cstddef>
+#include <new>
 #include <utility>
+#include <vector>
+
+#include "CheckPolicy.h"
+#include "VCStats.h"
+
+template <typename T>
+class BasicPositionalList;
 
 template <typename T>
-class PositionalList;
+class Position;
 
+/**
+* The links of a Position, to its neighbours and to its list, which are all
+* a list's sentinel needs.
+*/
 template <typename T>
-class Position {
+class PositionLinks {
   public:
-  PositionalList<T> *container;
-  T value;
   Position<T> *next;
   Position<T> *previous;
+  BasicPositionalList<T> *container;
+};
+
+template <typename T>
+class Position : public PositionLinks<T> {
+  public:
+  T value;
 
   Position() {}
-  Position(PositionalList<T> *container) : container(container) {}
+  Position(BasicPositionalList<T> *container) {
+    this->container = container;
+  }
   Position(T value) { this->value = value; }
-  Position(PositionalList<T> *container, T value) : container(container) {
+  Position(BasicPositionalList<T> *container, T value) {
+    this->container = container;
     this->value = value;
   }
 
+  /**
+  * The operations on a Position go through its list, so that they are
+  * checked as the list's policy decides.
+  */
   Position<T> *addAfter(T value) {
-    Position<T> *newNode = new Position<T>(container, value);
-    newNode->previous = this;
-    newNode->next = next;
-    next->previous = newNode;
-    next = newNode;
-    container->incrementSize();
-    return newNode;
+    return this->container->addAfter(this, value);
   }
 
   Position<T> *addBefore(T value) {
-    Position<T> *newNode = new Position<T>(container, value);
-    newNode->next = this;
-    newNode->previous = previous;
-    previous->next = newNode;
-    previous = newNode;
-    container->incrementSize();
-    return newNode;
+    return this->container->addBefore(this, value);
   }
 
   void remove() {
-    return container->remove(this);
+    return this->container->remove(this);
+  }
+};
+
+/**
+* Slab allocator for Positions.
+*
+* Positions are carved sequentially out of large contiguous slabs, and removed
+* Positions are threaded onto a free list so that the next insertion reuses
+* them instead of going back to the heap.  A single pool may be shared by any
+* number of PositionalLists (every bucket of a RangedBuckets shares one, for
+* instance), which makes it possible to throw away all of their nodes at once
+* with release().
+*
+* release() does not run destructors for Positions that are still live, so
+* it is only suitable for trivially destructible values or for values whose
+* cleanup the user has already handled.
+*/
+template <typename T>
+class PositionPool {
+  public:
+  /** Positions handed out per slab when none is specified. */
+  static const std::size_t DEFAULT_SLAB_SIZE = 1024;
+
+  /** Number of Positions in each slab. */
+  std::size_t slabSize;
+  /** Positions handed out from the current slab so far. */
+  std::size_t used;
+  /** Number of Positions currently handed out. */
+  std::size_t live;
+  /** Every slab ever allocated by this pool. */
+  std::vector<Position<T> *> slabs;
+
+  PositionPool(std::size_t slabSize = DEFAULT_SLAB_SIZE) :
+      slabSize(slabSize == 0 ? 1 : slabSize),
+      used(this->slabSize),
+      live(0),
+      freeList(nullptr) {}
+
+  ~PositionPool() {
+    release();
+  }
+
+  /**
+  * Obtains raw storage for one Position, preferring recently freed nodes.
+  * The storage is not constructed; use create() for that.
+  */
+  Position<T> *allocate() {
+    live++;
+    if (freeList != nullptr) {
+      FreeNode *node = freeList;
+      freeList = node->next;
+      return reinterpret_cast<Position<T> *>(node);
+    }
+    if (used == slabSize) {
+      VC_STAT(slabAllocations)
+      slabs.push_back(static_cast<Position<T> *>(
+          ::operator new(slabSize * sizeof(Position<T>))));
+      used = 0;
+    }
+    return slabs.back() + used++;
+  }
+
+  Position<T> *create(BasicPositionalList<T> *container) {
+    return new (allocate()) Position<T>(container);
+  }
+
+  Position<T> *create(BasicPositionalList<T> *container, T value) {
+    return new (allocate()) Position<T>(container, value);
+  }
+
+  /**
+  * Destroys a Position and returns its storage to the free list.
+  */
+  void destroy(Position<T> *position) {
+    position->~Position<T>();
+    FreeNode *node = reinterpret_cast<FreeNode *>(position);
+    node->next = freeList;
+    freeList = node;
+    live--;
+  }
+
+  /**
+  * Frees every slab at once.  All Positions handed out by this pool become
+  * invalid, and lists drawing on it must be rebuilt before further use.
+  */
+  void release() {
+    for (Position<T> *slab : slabs) {
+      ::operator delete(slab);
+    }
+    slabs.clear();
+    used = slabSize;
+    live = 0;
+    freeList = nullptr;
   }
+
+  private:
+  struct FreeNode {
+    FreeNode *next;
+  };
+
+  static_assert(sizeof(Position<T>) >= sizeof(FreeNode),
+      "Position must be able to hold a free list link.");
+
+  FreeNode *freeList;
 };
 
+/**
+* The doubly linked list underneath PositionalList, with no checks on the
+* Positions passed in.  Positions point back to the BasicPositionalList they
+* are in, so lists with different check policies share one Position type.
+*
+* remove, detach, addAfter and addBefore are virtual so that PositionalList
+* can check them whichever way they are reached: through a Position, through
+* a BasicPositionalList pointer, or through addFirst, addLast, removeFirst
+* and removeLast.
+*
+* Where Positions come from is left to subclasses through positionPool, so
+* that a list need not store a pool it shares with many others.  For the
+* same reason freeing unpooled Positions is left to PositionalList.
+*/
 template <typename T>
-class PositionalList {
+class BasicPositionalList {
   public:
+  /**
+  * Circular sentinel, stored inline so that an empty list allocates
+  * nothing: its next is the first Position and its previous the last.
+  * Only the links are stored; end() presents them as a Position whose value
+  * must never be read.  Lists therefore must not be copied or moved once
+  * constructed.
+  */
+  PositionLinks<T> sentinel;
   int size;
-  Position<T> *head;
-  Position<T> *tail;
 
-  //Uses sentinels
-  PositionalList() {
-    head = new Position<T>(this);
-    tail = new Position<T>(this);
-    head->previous = nullptr;
-    head->next = tail;
-    tail->previous = head;
-    tail->next = nullptr;
-    size = 0;
+  BasicPositionalList() : size(0) {
+    sentinel.next = end();
+    sentinel.previous = end();
+    sentinel.container = this;
   }
 
+  virtual ~BasicPositionalList() {}
+
+  BasicPositionalList(const BasicPositionalList &) = delete;
+  BasicPositionalList &operator=(const BasicPositionalList &) = delete;
+
   //Hooks for subclasses, particularly so that the data structure can be made
   //observable.
-  void incrementSize() { size++; }
-  void decrementSize() { size--; }
+  virtual void incrementSize() { size++; }
+  virtual void decrementSize() { size--; }
+
+  /**
+  * Source of this list's Positions.  Null means every Position is
+  * individually allocated with new and freed with delete.
+  */
+  virtual PositionPool<T> *positionPool() = 0;
+
+  /**
+  * Allocation hooks used by Position.  These go through the pool when one is
+  * present.
+  */
+  Position<T> *allocate() {
+    PositionPool<T> *pool = positionPool();
+    if (pool != nullptr) {
+      return pool->create(this);
+    }
+    return new Position<T>(this);
+  }
+
+  Position<T> *allocate(T value) {
+    VC_STAT(positionAllocations)
+    PositionPool<T> *pool = positionPool();
+    if (pool != nullptr) {
+      return pool->create(this, value);
+    }
+    return new Position<T>(this, value);
+  }
+
+  void deallocate(Position<T> *position) {
+    VC_STAT(positionFrees)
+    PositionPool<T> *pool = positionPool();
+    if (pool != nullptr) {
+      pool->destroy(position);
+    } else {
+      delete position;
+    }
+  }
 
   Position<T> *first() {
-    return head->next;
+    return sentinel.next;
   }
 
   Position<T> *last() {
-    return tail->previous;
+    return sentinel.previous;
+  }
+
+  /**
+  * The sentinel, reached when walking past either end of the list.
+  */
+  Position<T> *end() {
+    return static_cast<Position<T> *>(&sentinel);
   }
 
   /**
@@ -87,7 +263,7 @@ class PositionalList {
   * and pointers.  State contained within the list remains unchanged.
   */
   void foreachByValue(void (*apply)(T const value)) {
-    for (Position<t> *curr = first(); curr != tail; curr = curr->next) {
+    for (Position<T> *curr = first(); curr != end(); curr = curr->next) {
       apply(curr->value);
     }
   }
@@ -98,55 +274,171 @@ class PositionalList {
   * when the list contains complex objects.
   */
   void foreach(void (*apply)(T *const reference)) {
-    for (Position<T> *curr = first(); curr != tail; curr = curr->next) {
+    for (Position<T> *curr = first(); curr != end(); curr = curr->next) {
       apply(&curr->value);
     }
   }
 
-#ifndef NO_CHECKS
-  void error() {
-    exit(1);
+  virtual void remove(Position<T> *position) {
+    position->previous->next = position->next;
+    position->next->previous = position->previous;
+    deallocate(position);
+    decrementSize();
   }
 
-#define CHECK_CONTAINER(position) { if (position->container != this) error(); }
-#else
-#define CHECK_CONTAINER(position)
-#endif
-
-  void remove(Position<T> *position) {
-    CHECK_CONTAINER(position)
+  /**
+  * Unlinks a position without freeing it, so that it can be attached to
+  * another list sharing the same pool.
+  */
+  virtual void detach(Position<T> *position) {
     position->previous->next = position->next;
     position->next->previous = position->previous;
-    delete position;
     decrementSize();
   }
 
+  /**
+  * Links a detached position in at the end of this list.  The position
+  * keeps its address, so handles to it stay valid.
+  */
+  void attachLast(Position<T> *position) {
+    position->container = this;
+    position->next = end();
+    position->previous = sentinel.previous;
+    sentinel.previous->next = position;
+    sentinel.previous = position;
+    incrementSize();
+  }
+
   void removeFirst() {
-    remove(head->next);
+    remove(sentinel.next);
   }
 
   void removeLast() {
-    remove(tail->previous);
+    remove(sentinel.previous);
   }
 
-  Position<T> *addAfter(Position<T> *position, T value) {
-    CHECK_CONTAINER(position)
-    return position->addAfter(value);
+  virtual Position<T> *addAfter(Position<T> *position, T value) {
+    Position<T> *newNode = allocate(value);
+    newNode->previous = position;
+    newNode->next = position->next;
+    position->next->previous = newNode;
+    position->next = newNode;
+    incrementSize();
+    return newNode;
   }
 
-  Position<T> *addBefore(Position<T> *position, T value) {
-    CHECK_CONTAINER(position)
-    return position->addBefore(value);
+  virtual Position<T> *addBefore(Position<T> *position, T value) {
+    Position<T> *newNode = allocate(value);
+    newNode->next = position;
+    newNode->previous = position->previous;
+    position->previous->next = newNode;
+    position->previous = newNode;
+    incrementSize();
+    return newNode;
   }
 
   Position<T> *addFirst(T value) {
-    return addAfter(head, value);
+    return addAfter(end(), value);
   }
 
   Position<T> *addLast(T value) {
-    return addBefore(tail, value);
+    return addBefore(end(), value);
+  }
+
+};
+
+/**
+* The checks of PositionalList without its pool, for lists that find their
+* Positions elsewhere, such as the buckets of a RangedBuckets.
+*/
+template <typename T, class C = DefaultCheckPolicy>
+class PolicyPositionalList : public BasicPositionalList<T> {
+  public:
+  typedef BasicPositionalList<T> Basic;
+
+  void remove(Position<T> *position) {
+    checkRemovable(position);
+    Basic::remove(position);
+  }
+
+  void detach(Position<T> *position) {
+    checkRemovable(position);
+    Basic::detach(position);
   }
 
+  void removeFirst() {
+    checkNotEmpty();
+    Basic::removeFirst();
+  }
+
+  void removeLast() {
+    checkNotEmpty();
+    Basic::removeLast();
+  }
+
+  Position<T> *addAfter(Position<T> *position, T value) {
+    checkContainer(position);
+    return Basic::addAfter(position, value);
+  }
+
+  Position<T> *addBefore(Position<T> *position, T value) {
+    checkContainer(position);
+    return Basic::addBefore(position, value);
+  }
+
+  private:
+  void checkContainer(Position<T> *position) {
+    if (C::CHECKS && position->container != this) C::fail();
+  }
+
+  void checkRemovable(Position<T> *position) {
+    if (C::CHECKS && (position->container != this ||
+        position == this->end())) C::fail();
+  }
+
+  void checkNotEmpty() {
+    if (C::CHECKS && this->size == 0) C::fail();
+  }
+};
+
+/**
+* Positional list whose entry points check, as the policy C decides, that
+* the Positions handed to them are in this list and that there is something
+* to remove: the sentinel end() is never removed.  The checks override the
+* list's virtual operations, so Position::remove, addFirst, addLast and
+* calls through a BasicPositionalList pointer are checked too.  See
+* CheckPolicy.h.
+*/
+template <typename T, class C = DefaultCheckPolicy>
+class PositionalList : public PolicyPositionalList<T, C> {
+  public:
+  /**
+  * Source of this list's Positions.  Null means every Position is
+  * individually allocated with new and freed with delete.
+  */
+  PositionPool<T> *pool;
+
+  PositionalList(PositionPool<T> *pool = nullptr) : pool(pool) {}
+
+  /**
+  * Lists backed by a pool leave their Positions to the pool's owner, which
+  * can reclaim them all at once.  Unpooled lists free each node.
+  */
+  ~PositionalList() {
+    if (pool != nullptr) {
+      return;
+    }
+    Position<T> *curr = this->first();
+    while (curr != this->end()) {
+      Position<T> *next = curr->next;
+      delete curr;
+      curr = next;
+    }
+  }
+
+  PositionPool<T> *positionPool() {
+    return pool;
+  }
 };
 
 
@@ -0,0 +1,219 @@
+#ifndef RADIX_ADAPTABLE_HEAP__
+#define RADIX_ADAPTABLE_HEAP__
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AdaptableHeap.h"
+#include "VCStats.h"
+
+template <typename T>
+struct RadixHeapEntry {
+  T value;
+  int key;
+  std::uint32_t bucket;
+  std::uint32_t index;
+};
+
+/**
+* Adaptable max radix heap for monotone workloads: no key may ever exceed the
+* last top key found.  Greedy max degree is such a workload, since degrees
+* only fall and the maximum with them.
+*
+* Values are filed by the highest bit in which their key differs from that
+* last top: bucket 0 holds keys equal to it and bucket b keys differing first
+* in bit b - 1.  Finding the top when bucket 0 is empty takes the lowest
+* non-empty bucket, makes its greatest key the new last top and refiles the
+* bucket's values, each of which lands strictly lower.  A value therefore
+* moves at most 33 times in its life, so every operation is O(1) amortized
+* with no dependence on the key range, and adapt and eliminate are O(1).
+*
+* Shares the adaptable interface of DaryAdaptableHeap and the top half of
+* RangedAdaptablePriorityDeque's.
+*/
+template <typename T>
+class RadixAdaptableHeap {
+  public:
+  typedef RadixHeapEntry<T> Entry;
+  typedef Entry *Handle;
+
+  /** One bucket per bit of an int, plus one for keys equal to last. */
+  static const int BUCKETS = 33;
+
+  /** Highest valid key, named as for RangedBuckets. */
+  int topBucket;
+  /** Lowest valid key. */
+  int bottomBucket;
+  /** Number of values in the heap. */
+  std::size_t size;
+  /**
+  * Last top key found, initially the highest valid key.  Keys added or
+  * adapted to must not exceed it.
+  */
+  int last;
+
+  /**
+  * @param bottom The lowest valid key.
+  * @param top The highest valid key plus one.
+  */
+  RadixAdaptableHeap(int bottom, int top) :
+      topBucket(top - 1),
+      bottomBucket(bottom),
+      size(0),
+      last(top - 1),
+      occupied(0) {}
+
+  RadixAdaptableHeap(const RadixAdaptableHeap &) = delete;
+  RadixAdaptableHeap &operator=(const RadixAdaptableHeap &) = delete;
+
+  void error() {
+    exit(1);
+  }
+
+#ifndef NO_CHECKS
+#define CHECK_RADIX_KEY(key) { \
+  if (key < bottomBucket || key > last) error(); \
+}
+#define CHECK_RADIX_EMPTY if (size == 0) error();
+#else
+#define CHECK_RADIX_KEY(key)
+#define CHECK_RADIX_EMPTY
+#endif
+
+  Handle add(int key, T value) {
+    CHECK_RADIX_KEY(key)
+    Entry *entry = entries.allocate();
+    entry->value = value;
+    entry->key = key;
+    file(entry);
+    size++;
+    return entry;
+  }
+
+  int keyOf(Handle handle) {
+    return handle->key;
+  }
+
+  /**
+  * Changes the key of a value, to no more than last.  The handle stays
+  * valid and is returned.
+  */
+  Handle adapt(Handle handle, int key) {
+    CHECK_RADIX_KEY(key)
+    unfile(handle);
+    handle->key = key;
+    file(handle);
+    return handle;
+  }
+
+  void eliminate(Handle handle) {
+    unfile(handle);
+    entries.free(handle);
+    size--;
+  }
+
+  /**
+  * The highest key, which becomes the new last.  Only meaningful when not
+  * empty.
+  */
+  int topKey() {
+    if ((occupied & 1) == 0) {
+      settle();
+    }
+    return last;
+  }
+
+  T peepTop() {
+    CHECK_RADIX_EMPTY
+    topKey();
+    return buckets[0].back()->value;
+  }
+
+  T popTop() {
+    CHECK_RADIX_EMPTY
+    VC_STAT(pops)
+    topKey();
+    Entry *entry = buckets[0].back();
+    T value = entry->value;
+    eliminate(entry);
+    return value;
+  }
+
+  /**
+  * Removes every value, invalidating every handle.  last is kept, so the
+  * heap stays monotone across clears.
+  */
+  void clear() {
+    for (int b = 0; b < BUCKETS; b++) {
+      buckets[b].clear();
+    }
+    entries.release();
+    occupied = 0;
+    size = 0;
+  }
+
+  private:
+  std::vector<Entry *> buckets[BUCKETS];
+  /** Bit b set while bucket b is non-empty. */
+  std::uint64_t occupied;
+  HeapEntrySlabs<Entry> entries;
+
+  int bucketOf(int key) {
+    std::uint32_t differing = (std::uint32_t) key ^ (std::uint32_t) last;
+    return differing == 0 ? 0 : 32 - __builtin_clz(differing);
+  }
+
+  void file(Entry *entry) {
+    int b = bucketOf(entry->key);
+    std::vector<Entry *> &bucket = buckets[b];
+    entry->bucket = (std::uint32_t) b;
+    entry->index = (std::uint32_t) bucket.size();
+    bucket.push_back(entry);
+    occupied |= (std::uint64_t) 1 << b;
+  }
+
+  /**
+  * Takes an entry out of its bucket, moving the bucket's last entry into
+  * its place.
+  */
+  void unfile(Entry *entry) {
+    std::vector<Entry *> &bucket = buckets[entry->bucket];
+    Entry *moved = bucket.back();
+    bucket[entry->index] = moved;
+    moved->index = entry->index;
+    bucket.pop_back();
+    if (bucket.empty()) {
+      occupied &= ~((std::uint64_t) 1 << entry->bucket);
+    }
+  }
+
+  /**
+  * Makes the greatest key the new last, so that bucket 0 is non-empty.
+  * Keys below last and equal down to bit b - 1 share their higher bits
+  * with every other key of bucket b, and so with its greatest key: each
+  * refiled key lands in a bucket below b.
+  */
+  void settle() {
+    int b = __builtin_ctzll(occupied);
+    std::vector<Entry *> &bucket = buckets[b];
+    int greatest = bucket[0]->key;
+    for (Entry *entry : bucket) {
+      greatest = entry->key > greatest ? entry->key : greatest;
+    }
+    last = greatest;
+    std::vector<Entry *> refile;
+    refile.swap(bucket);
+    occupied &= ~((std::uint64_t) 1 << b);
+    for (Entry *entry : refile) {
+      file(entry);
+    }
+    //Keep the bucket's capacity for its next use.
+    refile.clear();
+    bucket.swap(refile);
+  }
+};
+
+#endif
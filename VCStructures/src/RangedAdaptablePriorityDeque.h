@@ -4,9 +4,9 @@
 #include "RangedBuckets.h"
 
 /**
-* Struct that can possibly take up no space.
-* Hopefully the compiler will allow the unused "value" field from each
-* BucketPositionalList to take up no space.
+* Struct that can take up no space: BucketPositionalList declares its value
+* [[no_unique_address]], so where that is supported the unused field costs
+* nothing in each bucket.
 */
 struct Empty {};
 
@@ -19,116 +19,165 @@ struct Empty {};
 *
 * Implements Adaptable Priority Queue functionality: allows key changes and
 * random removal of pairs- though this functionality requires external storage
-* of data positions.
+* of data positions.  When the values are a fixed set that maps onto dense
+* indices, such as vertices, IndexedRangedPriorityDeque avoids that by using
+* the value itself as the handle.
 *
 * There is no difference between this and a RangedBuckets-based implementation
 * of a regular Priority Queue besides allowing the user to pop from either end;
 * no performance loss is incurred by the availability of double-ended pops.
+*
+* The adaptable queue interface (Handle, add, adapt, eliminate, keyOf and the
+* top operations) is shared with DaryAdaptableHeap and RadixAdaptableHeap,
+* which trade constant time for memory independent of the key range.
+*
+* C is the check policy, as for RangedBuckets, and also covers popping or
+* peeping into an empty deque.
 */
-template<class T>
-class RangedAdaptablePriorityDeque : RangedBuckets<Empty, T> {
+template<class T, class C = DefaultCheckPolicy>
+class RangedAdaptablePriorityDeque : public RangedBuckets<Empty, T, C> {
 public:
-  /** The top valid bucket plus one. */
-  int top;
-  /** The bottom valid bucket. */
-  int bottom;
- 
-  void null_function() {}
+  typedef RangedBuckets<Empty, T, C> Buckets;
+  typedef Position<T> *Handle;
+
+  static void null_function(void *) {}
 
   void (*notification_function)(void *);
 
   /**
   * Constructor for RangedAdaptablePriorityDeque.
   *
-  * Though top and bottom are respectively upper and lower bounds for the
-  * position of valid data, top is initialized at bottom and the opposite
-  * for bottom.  This is because adding adjusts these values to a more
-  * tightly constrained position than simply the ends of the array.
+  * Pops find the extreme non-empty bucket through the occupancy bitmap kept
+  * by RangedBuckets, so no bound needs to be tracked here and sparse key
+  * ranges cost nothing to skip over.
   *
   * @param bottom The lowest valid bucket.
   * @param top The highest valid bucket plus one.
+  * @param pool Optional PositionPool to share with other structures.
   */
-  RangedAdaptablePriorityDeque(int bottom, int top) :
-      RangedBuckets<Empty, T>(bottom, top),
-      top(bottom),
-      bottom(top - 1),
-      notification_function(null_function);
-      {}
-
-#ifndef NO_CHECKS
-#define CHECK_EMPTY if (size == 0) error();
-#else
-#define CHECK_EMPTY
-#endif
+  RangedAdaptablePriorityDeque(int bottom, int top,
+      PositionPool<T> *pool = nullptr) :
+      Buckets(bottom, top, pool),
+      notification_function(null_function) {}
+
+  /**
+  * Constructor for a deque whose key range can later grow, anywhere within
+  * [reserveBottom, reserveTop), with grow.
+  */
+  RangedAdaptablePriorityDeque(int bottom, int top, int reserveBottom,
+      int reserveTop, PositionPool<T> *pool = nullptr) :
+      Buckets(bottom, top, reserveBottom, reserveTop, pool),
+      notification_function(null_function) {}
 
   struct DequeVoid {
-    RangedAdaptablePriorityDeque<T> *deque;
+    RangedAdaptablePriorityDeque<T, C> *deque;
     void *pointer;
   };
 
   void notify(void *p) {
     DequeVoid dv = {this, p};
-    notifcation_function(&dv);
+    notification_function(&dv);
   }
 
   void setNotificationFunction(void (*notification)(void *)) {
     notification_function = notification;
   }
 
-  P peepTop() {
-    CHECK_EMPTY
-    while (bucket(top).size == 0) {
-      top--;
-    }
-    return bucket(top).first()->value;
+  /**
+  * Key of the highest non-empty bucket.  Only meaningful when not empty.
+  */
+  int topKey() {
+    return this->previousOccupied(this->topBucket);
   }
 
-  P peepBottom() {
-    CHECK_EMPTY
-    while (data[bottom].size == 0) {
-      bottom++;
-    }
-    return data[bottom].last()->value;
+  /**
+  * Key of the lowest non-empty bucket.  Only meaningful when not empty.
+  */
+  int bottomKey() {
+    return this->nextOccupied(this->bottomBucket);
   }
 
-  P popTop() {
-    CHECK_EMPTY
-    while (bucket(top).size == 0) {
-      top--;
-    }
-    Position<P> *toRemove = data[top].first();
-    P value = toRemove->value;
+  T peepTop() {
+    checkNotEmpty();
+    return this->bucket(topKey())->first()->value;
+  }
+
+  T peepBottom() {
+    checkNotEmpty();
+    return this->bucket(bottomKey())->last()->value;
+  }
+
+  T popTop() {
+    checkNotEmpty();
+    VC_STAT(pops)
+    Position<T> *toRemove = this->bucket(topKey())->first();
+    T value = toRemove->value;
     toRemove->remove();
     return value;
   }
 
-  P popBottom() {
-    CHECK_EMPTY
-    while (bucket(bottom).size == 0) {
-      bottom++;
-    }
-    Position<P> *toRemove = bucket(bottom).last();
-    P value = toRemove->value;
+  T popBottom() {
+    checkNotEmpty();
+    VC_STAT(pops)
+    Position<T> *toRemove = this->bucket(bottomKey())->last();
+    T value = toRemove->value;
     toRemove->remove();
     return value;
   }
 
-  Position<P> *adapt(Position<P> *position, int bucket) {
-    P value = position->value;
-    remove(position);
-    return add(bucket, value);
+  /**
+  * Changes the key of a position.  The position is relinked into its new
+  * bucket rather than reallocated, so the handle passed in stays valid and
+  * is also what is returned.
+  */
+  Position<T> *adapt(Position<T> *position, int bucket) {
+    this->move(position, bucket);
+    return position;
   }
   
-  Position<P> *adapt_fn(Position<P> *position, int bucket, void (*onPos)(Position<P> *)) {
-    P value = position->value;
-    remove(position);
-    return add_fn(bucket, value, onPos);
+  /**
+  * Kept for callers that refresh their stored handle through onPos.  Since
+  * adapt no longer invalidates handles, onPos receives the same position.
+  */
+  Position<T> *adapt_fn(Position<T> *position, int bucket, void (*onPos)(Position<T> *)) {
+    this->move(position, bucket);
+    onPos(position);
+    return position;
+  }
+
+  /**
+  * In-place key change, equivalent to adapt.
+  */
+  void moveToBucket(Position<T> *position, int bucket) {
+    this->move(position, bucket);
+  }
+
+  /**
+  * Shifts the key of every given position by delta, as when every neighbor
+  * of a removed vertex loses one degree.  Each position is relinked in place;
+  * no Position is freed or allocated and every handle stays valid.
+  *
+  * @param positions The positions to adapt.
+  * @param count Number of positions.
+  * @param delta Amount to add to each key.
+  */
+  void adaptBatch(Position<T> *const *positions, std::size_t count,
+      int delta) {
+    for (std::size_t i = 0; i < count; i++) {
+      Position<T> *position = positions[i];
+      this->move(position, this->keyOf(position) + delta);
+    }
+  }
+
+  void eliminate(Position<T> *position) {
+    this->remove(position);
   }
 
-  void eliminate(Position<P> *position) {
-    remove(position);
+private:
+  void checkNotEmpty() {
+    if (C::CHECKS && this->size == 0) C::fail();
   }
 
-}
+};
 
 #endif
@@ -1,11 +1,14 @@
 #ifndef RANGED_BUCKETS__
 #define RANGED_BUCKETS__
 
-#ifndef NO_CHECKS
 #include <stdlib.h>
-#endif
+#include <sys/mman.h>
 
+#include "OccupancyBitmap.h"
 #include "PositionalList.h"
+#include "VCStats.h"
+#include <cstddef>
+#include <new>
 #include <utility>
 
 /**
@@ -17,20 +20,58 @@
 * PositionalLists so that users can safely perform Position or PositionalList
 * operations on enclosed objects.
 */
-template <class V, class P>
-class BucketPositionalList : public PositionalList<P> {
+template <class V, class P, class C = DefaultCheckPolicy>
+class RangedBuckets;
+
+/**
+* Lets an empty V share its address with a neighbouring member.  Before
+* C++20 the attribute is usually ignored and an empty V costs its padding.
+*/
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(no_unique_address)
+#define VC_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+#endif
+#ifndef VC_NO_UNIQUE_ADDRESS
+#define VC_NO_UNIQUE_ADDRESS
+#endif
+
+/**
+* Buckets draw on their parent's pool rather than storing it.  value comes
+* before parent so that a small V fills the padding after the list's size.
+*/
+template <class V, class P, class C = DefaultCheckPolicy>
+class BucketPositionalList : public PolicyPositionalList<P, C> {
   public:
-  int key;
-  V value;
-  RangedBuckets<V, P> *parent;
+  VC_NO_UNIQUE_ADDRESS V value;
+  RangedBuckets<V, P, C> *parent;
+
+  BucketPositionalList() : parent(nullptr) {}
+
+  BucketPositionalList(RangedBuckets<V, P, C> *parent) :
+      parent(parent) {}
+
+  PositionPool<P> *positionPool() {
+    return parent->pool;
+  }
+
+  /**
+  * Buckets sit in one array indexed by key, so the key is not stored.
+  */
+  int key() {
+    return (int) (this - parent->data);
+  }
 
   /**
   * Method to allow RangedBuckets size to be controlled by the enclosed
   * PositionalLists.
   */
   void incrementSize() {
-    PositionalList<P>::incrementSize();
-    RangedBuckets->incrementSize();
+    PolicyPositionalList<P, C>::incrementSize();
+    if (this->size == 1) {
+      parent->occupy(key());
+    }
+    parent->incrementSize();
   }
 
   /**
@@ -38,7 +79,10 @@ class BucketPositionalList : public PositionalList<P> {
   * PositionalLists.
   */
   void decrementSize() {
-    PositionalList<P>::decrementSize();
+    PolicyPositionalList<P, C>::decrementSize();
+    if (this->size == 0) {
+      parent->vacate(key());
+    }
     parent->decrementSize();
   }
     
@@ -58,19 +102,32 @@ class BucketPositionalList : public PositionalList<P> {
 * When a RangedBuckets implementation is possible, many operations in said ADTs
 * are reduced to constant time with significantly less overhead.
 *
-* This can also be used to quickly implement Counting Sort.
+* This can also be used to quickly implement Counting Sort; RangedSort.h has
+* a flattened, contiguous version of that for bulk sorting.
 *
 * *Graphs can be represented as a one to many mapping from a vertex to edges or,
 *   in a simpler implementation, other vertices.
+*
+* C is the policy for checking bucket bounds, which the buckets also apply
+* to their own PositionalList operations; see CheckPolicy.h.
+*
+* Every bucket is a PositionalList without a pool of its own: a vtable
+* pointer, the sentinel's links, size and parent, 48 bytes on LP64 with a V
+* of at most four bytes, whether or not it is ever used.  The vtable stays
+* because Positions reach their bucket through a BasicPositionalList
+* pointer, and removing one must still update these buckets.  Construction
+* allocates no Positions, but a wide, sparsely used key range still costs
+* 48 bytes per key.  For such ranges CompactRangedBuckets and
+* IndexedRangedPriorityDeque take 8 to 12 bytes per bucket.
 */
-template<class V, class P>
+template<class V, class P, class C>
 class RangedBuckets {
   public:
   /**
   * Pointer to key "0".  Valid memory starts at data[bottom] and ends
   * at data[top - 1].  May be negatively indexed.
   */
-  BucketPositionalList<V, P> *data;
+  BucketPositionalList<V, P, C> *data;
 
   /** Index of the top valid bucket. */
   int topBucket;
@@ -80,6 +137,22 @@ class RangedBuckets {
   std::size_t size;
   /** Number of buckets. */
   std::size_t buckets;
+  /** Shared source of Positions for every bucket. */
+  PositionPool<P> *pool;
+  /** Whether pool was created by, and should be freed with, these buckets. */
+  bool ownsPool;
+  /**
+  * Range grow may extend the buckets to: reserveBottom up to but excluding
+  * reserveTop.  Equal to the initial range unless one was reserved.
+  */
+  int reserveBottom;
+  int reserveTop;
+  /** Whether buckets live in a reserved mapping rather than on the heap. */
+  bool reserved;
+  /**
+  * One bit per bucket from reserveBottom, set while the bucket is non-empty.
+  */
+  OccupancyBitmap occupied;
 
   /**
   * Constructor for RangedBuckets.
@@ -89,67 +162,250 @@ class RangedBuckets {
   * for bottom.  This is because adding adjusts these values to a more
   * tightly constrained position than simply the ends of the array.
   *
+  * All buckets draw their Positions from a single PositionPool.  One may be
+  * passed in to share it with other structures; otherwise the buckets make
+  * and own their own.
+  *
   * @param bottom The lowest valid bucket.
   * @param top The highest valid bucket plus one.
+  * @param pool Optional pool to draw Positions from.
   */
-  RangedBuckets(int bottom, int top) : 
-      size(0),
+  RangedBuckets(int bottom, int top, PositionPool<P> *pool = nullptr) :
+      RangedBuckets(bottom, top, bottom, top, pool) {}
+
+  /**
+  * Constructor for RangedBuckets that can later grow.
+  *
+  * Address space for every bucket in [reserveBottom, reserveTop) is
+  * reserved up front, but only the pages of buckets actually constructed
+  * are ever touched, so a generous reservation costs no memory.  Since
+  * buckets never move, grow keeps data pointing at key "0" and every
+  * Position handle valid.
+  *
+  * @param bottom The lowest valid bucket.
+  * @param top The highest valid bucket plus one.
+  * @param reserveBottom The lowest bucket grow may reach.
+  * @param reserveTop The highest bucket grow may reach, plus one.
+  * @param pool Optional pool to draw Positions from.
+  */
+  RangedBuckets(int bottom, int top, int reserveBottom, int reserveTop,
+      PositionPool<P> *pool = nullptr) :
       topBucket(top - 1),
       bottomBucket(bottom),
-      buckets(top - bottom) {
-    data = new BucketPositionalList<V, P>[buckets]();
+      size(0),
+      buckets(top - bottom),
+      pool(pool != nullptr ? pool : new PositionPool<P>()),
+      ownsPool(pool == nullptr),
+      reserveBottom(reserveBottom),
+      reserveTop(reserveTop),
+      reserved(reserveBottom < bottom || reserveTop > top),
+      occupied(top - reserveBottom) {
+    if (reserveBottom > bottom || reserveTop < top) {
+      error();
+    }
+    BucketPositionalList<V, P, C> *base;
+    if (reserved) {
+      void *mapped = mmap(nullptr, reservedBytes(), PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (mapped == MAP_FAILED) {
+        error();
+      }
+      base = static_cast<BucketPositionalList<V, P, C> *>(mapped);
+    } else {
+      base = static_cast<BucketPositionalList<V, P, C> *>(
+          ::operator new(buckets * sizeof(BucketPositionalList<V, P, C>)));
+    }
     //Set data to point to the "0" key.
-    data = data - bottom;
+    data = base - reserveBottom;
+    construct(bottom, top);
   }
 
-  void incrementSize() {
+  /**
+  * Positions are never visited individually: they are reclaimed all at once
+  * when the pool is released.
+  */
+  virtual ~RangedBuckets() {
+    for (int i = bottomBucket; i <= topBucket; i++) {
+      data[i].~BucketPositionalList<V, P, C>();
+    }
+    if (reserved) {
+      munmap(data + reserveBottom, reservedBytes());
+    } else {
+      ::operator delete(data + bottomBucket);
+    }
+    if (ownsPool) {
+      delete pool;
+    }
+  }
+
+  /**
+  * Extends the valid range to [newBottom, newTop), which must lie within
+  * the reservation.  Only the new buckets are constructed: O(new buckets).
+  * The range never shrinks, so either bound may be left where it is.
+  */
+  void grow(int newBottom, int newTop) {
+    if (newBottom < reserveBottom || newTop > reserveTop) {
+      error();
+    }
+    if (newBottom < bottomBucket) {
+      construct(newBottom, bottomBucket);
+      bottomBucket = newBottom;
+    }
+    if (newTop > topBucket + 1) {
+      construct(topBucket + 1, newTop);
+      occupied.grow(newTop - reserveBottom);
+      topBucket = newTop - 1;
+    }
+    buckets = topBucket + 1 - bottomBucket;
+  }
+
+  /**
+  * Drops every Position in every bucket in one step, leaving all buckets
+  * empty.  Only valid when the pool is owned by these buckets, since a shared
+  * pool may hold Positions belonging to other structures.
+  */
+  void clear() {
+    if (!ownsPool) {
+      error();
+    }
+    for (int i = bottomBucket; i <= topBucket; i++) {
+      data[i].~BucketPositionalList<V, P, C>();
+    }
+    pool->release();
+    occupied.reset();
+    construct(bottomBucket, topBucket + 1);
+    size = 0;
+  }
+
+  virtual void incrementSize() {
+    VC_STAT(bucketInserts)
     size++;
   }
 
-  void decrementSize() {
+  virtual void decrementSize() {
+    VC_STAT(bucketRemovals)
     size--;
   }
 
-#ifndef NO_CHECKS
-#define CHECK_BOUNDS(bucket) { \
-  if (bucket < bottomBucket || buckect > topBucket) error(); \
-}
+  /**
+  * Occupancy hooks, called by a bucket when it goes from empty to non-empty
+  * and back.
+  */
+  void occupy(int key) {
+    occupied.set(key - reserveBottom);
+  }
+
+  void vacate(int key) {
+    occupied.clear(key - reserveBottom);
+  }
+
+  /**
+  * @return The lowest non-empty bucket at or above key, or topBucket + 1 if
+  * there is none.
+  */
+  int nextOccupied(int key) {
+    if (key < bottomBucket) {
+      key = bottomBucket;
+    }
+    std::size_t found = occupied.next(key - reserveBottom);
+    VC_STAT(occupancySearches)
+    if (found == OccupancyBitmap::NONE) {
+      VC_STAT_ADD(emptyBucketsSkipped, topBucket + 1 - key)
+      return topBucket + 1;
+    }
+    VC_STAT_ADD(emptyBucketsSkipped, found - (key - reserveBottom))
+    return reserveBottom + (int) found;
+  }
+
+  /**
+  * @return The highest non-empty bucket at or below key, or bottomBucket - 1
+  * if there is none.
+  */
+  int previousOccupied(int key) {
+    if (key < bottomBucket) {
+      return bottomBucket - 1;
+    }
+    if (key > topBucket) {
+      key = topBucket;
+    }
+    std::size_t found = occupied.previous(key - reserveBottom);
+    VC_STAT(occupancySearches)
+    if (found == OccupancyBitmap::NONE) {
+      VC_STAT_ADD(emptyBucketsSkipped, key + 1 - bottomBucket)
+      return bottomBucket - 1;
+    }
+    VC_STAT_ADD(emptyBucketsSkipped, (key - reserveBottom) - found)
+    return reserveBottom + (int) found;
+  }
 
   void error() {
     exit(1);
   }
 
-#else
-#define CHECK_BOUNDS(bucket)
-#endif
+  /**
+  * Constructs the buckets from bottom up to but excluding top in place.
+  */
+  void construct(int bottom, int top) {
+    for (int i = bottom; i < top; i++) {
+      new (data + i) BucketPositionalList<V, P, C>(this);
+    }
+  }
+
+  std::size_t reservedBytes() {
+    return (std::size_t) (reserveTop - reserveBottom) *
+        sizeof(BucketPositionalList<V, P, C>);
+  }
 
   /**
   * Simply returns the bucket at a given index.
-  * Should be the primary access method as it may include bound checking.
+  * Should be the primary access method as it checks bounds when the policy
+  * C does.
   */
-  BucketPositionalList<V, P> *bucket(int bucket) {
-    CHECK_BOUNDS(bucket)
-    return data[bucket];
+  BucketPositionalList<V, P, C> *bucket(int bucket) {
+    if (C::CHECKS && (bucket < bottomBucket || bucket > topBucket)) C::fail();
+    return data + bucket;
   }
 
   /**
   * Adds a value at the given bucket.
-  * @param bucket The given bucket.
+  * @param key The given bucket.
   * @param value The given value.
   * @return The position of the new pairing- it's important that the user
   * store this externally.
   */
-  Position<P> *add(int bucket, P value) {
-    auto position = bucket(bucket).addLast(value);
+  Position<P> *add(int key, P value) {
+    auto position = bucket(key)->addLast(value);
     return position;
   }
 
-  Position<P> *add(int bucket, P value, void (*onPos)(Position<P> *)) {
-    auto position = bucket(bucket).addLast(value);
+  Position<P> *add(int key, P value, void (*onPos)(Position<P> *)) {
+    auto position = bucket(key)->addLast(value);
     onPos(position);
     return position;
   }
 
+  /**
+  * Key of the bucket a position is currently in.
+  */
+  int keyOf(Position<P> *position) {
+    return static_cast<BucketPositionalList<V, P, C> *>(
+        position->container)->key();
+  }
+
+  /**
+  * Moves a position to the end of another bucket in place.  Nothing is
+  * allocated or freed and the position remains a valid handle.
+  *
+  * @param position The position to move.
+  * @param key The bucket to move it to.
+  */
+  void move(Position<P> *position, int key) {
+    BucketPositionalList<V, P, C> *to = bucket(key);
+    VC_STAT(adaptMoves)
+    position->container->detach(position);
+    to->attachLast(position);
+  }
+
   /**
   * Removes the given position.
   *
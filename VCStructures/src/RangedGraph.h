@@ -1,12 +1,15 @@
 #ifndef RANGED_GRAPH__
-#define RANGED_BUCKETS__
+#define RANGED_GRAPH__
 
 #ifndef NO_CHECKS
 #include <stdlib.h>
 #endif
 
 #include "RangedBuckets.h"
+#include "VCStats.h"
 
+template<class V, class E>
+class RangedGraph;
 
 /**
 * The edge handles almost all of the concrete functionality for RangedGraph.
@@ -16,23 +19,24 @@
 */
 template<class V, class E>
 class Edge {
-  E value;
-  Position<Edge<E> *> *left;
-  Position<Edge<E> *> *right;
+  public:
   RangedGraph<V, E> *parent;
+  E value;
+  Position<Edge<V, E> *> *left;
+  Position<Edge<V, E> *> *right;
 
   /**
   * Creates an edge and links the vertices to one another.
   */
   Edge(RangedGraph<V, E> *container, int left, int right, E value) :
       parent(container),
-      left(parent->add(left, this)),
-      right(parent->add(right, this)) {
+      left(container->add(left, this)),
+      right(container->add(right, this)) {
     this->value = value;
     parent->incrementEdgeCount();
   }
 
-  Position<Edge<E> *> *neighbor(Position<Edge<E> *current) {
+  Position<Edge<V, E> *> *neighbor(Position<Edge<V, E> *> *current) {
     if (left == current) {
       return right;
     } else if (right == current) {
@@ -45,8 +49,8 @@ class Edge {
   * Destroys an edge and unlinks the vertices.
   */
   ~Edge() {
-    edge->left->remove();
-    edge->right->remove();
+    left->remove();
+    right->remove();
     parent->decrementEdgeCount();
   }
 
@@ -58,15 +62,17 @@ class Edge {
 * everything needed to be a vertex a simple renaming of the type makes
 * the code more readable.
 */
-template<class V>
-using Vertex<V> = BucketPositionalList<V, Edge<E> *>;
+template<class V, class E>
+using Vertex = BucketPositionalList<V, Edge<V, E> *>;
 
 template<class V, class E>
 class RangedGraphInterface {
-  virtual Edge<E> *addEdge(int left, int right, E value);
-  virtual void removeEdge(Edge<E> *edge);
-  virtual void removeVertex(int vertex);
-}
+  public:
+  virtual ~RangedGraphInterface() {}
+  virtual Edge<V, E> *addEdge(int left, int right, E value) = 0;
+  virtual void removeEdge(Edge<V, E> *edge) = 0;
+  virtual void removeVertex(int vertex) = 0;
+};
 
 /**
 * RangedBuckets-based Graph implementation.  Currently, graph features
@@ -77,33 +83,53 @@ class RangedGraphInterface {
 */
 template<class V, class E>
 class RangedGraph :
-    public RangedBuckets<V, Edge<E> *>,
-    RangedGraphInterface<V, E> {
+    public RangedBuckets<V, Edge<V, E> *>,
+    public RangedGraphInterface<V, E> {
   public:
   int edgeCount;
 
-  RangedGraph(int bottom, int  top) :
-      RangedBuckets(bottom, top),
+  /**
+  * @param pool Optional PositionPool for the adjacency lists, which may be
+  * shared with other structures built over the same graph.
+  */
+  RangedGraph(int bottom, int top,
+      PositionPool<Edge<V, E> *> *pool = nullptr) :
+      RangedBuckets<V, Edge<V, E> *>(bottom, top, pool),
       edgeCount(0) {}
 
-  Vertex<V> *getVertex(int vertex) {
-    return bucket(vertex);
+  /**
+  * Frees every remaining edge.  Each edge is deleted once, from the
+  * adjacency of whichever endpoint is reached first.
+  */
+  ~RangedGraph() {
+    for (int v = this->bottomBucket; v <= this->topBucket; v++) {
+      Vertex<V, E> *vertex = this->bucket(v);
+      while (vertex->size != 0) {
+        delete vertex->first()->value;
+      }
+    }
+  }
+
+  Vertex<V, E> *getVertex(int vertex) {
+    return this->bucket(vertex);
   }
 
   /**
   * There is no trivial lookup for edges available, thus to keep track of edges
   * a pointer must be stored externally.
   */
-  Edge<E> *addEdge(int left, int right, E value) {
-    return new Edge<E>(left, right, value);
+  Edge<V, E> *addEdge(int left, int right, E value) {
+    return new Edge<V, E>(this, left, right, value);
   }
 
-  void removeEdge(Edge<E> *edge) {
+  void removeEdge(Edge<V, E> *edge) {
+    VC_STAT(edgesRemoved)
     delete edge;
   }
 
   void removeVertex(int vertex) {
-    Vertex<V> *v = bucket(vertex);
+    VC_STAT(verticesRemoved)
+    Vertex<V, E> *v = this->bucket(vertex);
 
     while (v->size != 0) {
       removeEdge(v->first()->value);
@@ -119,11 +145,11 @@ class RangedGraph :
   }
 
   void incrementVertexCount() {
-    size++;
+    this->size++;
   }
 
   void decrementVertexCount() {
-    size--;
+    this->size--;
   }
 
   void incrementSize() {
@@ -134,7 +160,10 @@ class RangedGraph :
     decrementVertexCount();
   }
 
-}
+};
+
+template<class V, class E>
+class EntangledRangedGraph;
 
 /**
 * Entanglement interface for RangedGraph.
@@ -161,34 +190,43 @@ class RangedGraph :
 */
 template<class V, class E>
 class RangedGraphEntanglement {
+  public:
   Position<RangedGraphEntanglement<V, E> *> *position;
   EntangledRangedGraph<V, E> *graph;
 
-  void entangle(EntangedRangedGraph<V, E> *graph) {
+  void entangle(EntangledRangedGraph<V, E> *graph) {
     this->graph = graph;
-    position = graph->entanglements->addLast(this);
+    position = graph->entanglements.addLast(this);
   }
 
+  /**
+  * Stops following the graph.  Entanglements that entangle themselves
+  * should call this from their destructor when graph is not null, or the
+  * graph calls through a dangling pointer on its next change.
+  */
   void disentangle() {
     position->remove();
+    position = nullptr;
     graph = nullptr;
   }
 
   RangedGraphEntanglement() :
-      graph(nullptr),
-      position(nullptr) {}
-
-  void beforeAddEdge(int left, int right, E value) {}
-  void afterAddEdge(const Edge<E> *e) {}
-  void beforeRemoveEdge(const Edge<E> *edge) {}
-  void afterRemoveEdge() {}
-  void beforeRemoveVertex(int vertex) {}
-  void afterRemoveVertex() {}
-  void afterIncrementEdgeCount() {}
-  void afterDecrementEdgeCount() {}
-  void afterIncrementVertexCount() {}
-  void afterDecrementVertexCount() {}
-}
+      position(nullptr),
+      graph(nullptr) {}
+
+  virtual ~RangedGraphEntanglement() {}
+
+  virtual void beforeAddEdge(int left, int right, E value) {}
+  virtual void afterAddEdge(const Edge<V, E> *e) {}
+  virtual void beforeRemoveEdge(const Edge<V, E> *edge) {}
+  virtual void afterRemoveEdge() {}
+  virtual void beforeRemoveVertex(int vertex) {}
+  virtual void afterRemoveVertex() {}
+  virtual void afterIncrementEdgeCount() {}
+  virtual void afterDecrementEdgeCount() {}
+  virtual void afterIncrementVertexCount() {}
+  virtual void afterDecrementVertexCount() {}
+};
 
 /**
 * Entangled version of RangedGraph.  This interface allows a user to inject
@@ -200,7 +238,25 @@ template<class V, class E>
 class EntangledRangedGraph : public
     RangedGraph<V, E> {
   public:
-  PositionalList<RangedGraphEntanglement<V, E> *> *entanglements;
+  typedef RangedGraphEntanglement<V, E> Entanglement;
+
+  PositionalList<Entanglement *> entanglements;
+
+  EntangledRangedGraph(int bottom, int top,
+      PositionPool<Edge<V, E> *> *pool = nullptr) :
+      RangedGraph<V, E>(bottom, top, pool) {}
+
+  /**
+  * Leaves entanglements that outlive the graph with a null graph, so that
+  * their own destructors do not reach back into it.
+  */
+  ~EntangledRangedGraph() {
+    for (Position<Entanglement *> *e = entanglements.first();
+        e != entanglements.end(); e = e->next) {
+      e->value->graph = nullptr;
+      e->value->position = nullptr;
+    }
+  }
 
 #ifdef STACK_ENTANGLEMENT__
 #define ENTANGLEMENT_STACK EntanglementState state[entanglements->size];
@@ -215,39 +271,130 @@ class EntangledRangedGraph : public
 #define ENTANGLEMENT_STACK
 #endif
 
-  Edge<E> *addEdge(int left, int right, E value) {
+  Edge<V, E> *addEdge(int left, int right, E value) {
     ENTANGLEMENT_STACK
-    entanglements->foreachByValue([](RangedGraphEntanglement<V, E> *e) {
-      e->beforeAddEdge(left, right, value); 
-    });
-    Edge<E> *newEdge = RangedGraph<V, E>::addEdge(left, right, value);
-    entanglements->foreachByValue([=](RangedGraphEntanglement<V, E> *e)
-        -> {
-      e->afterAddEdge(newEdge); 
-    });
-    return newEdge;    
-  }
-
-  void removeEdge(Edge<E> *edge) {
+    for (Position<Entanglement *> *e = entanglements.first();
+        e != entanglements.end(); e = e->next) {
+      e->value->beforeAddEdge(left, right, value);
+    }
+    Edge<V, E> *newEdge = RangedGraph<V, E>::addEdge(left, right, value);
+    for (Position<Entanglement *> *e = entanglements.first();
+        e != entanglements.end(); e = e->next) {
+      e->value->afterAddEdge(newEdge);
+    }
+    return newEdge;
+  }
+
+  void removeEdge(Edge<V, E> *edge) {
     ENTANGLEMENT_STACK
-    entanglements->foreachByValue([](RangedGraphEntanglement<V, E> *e) {
-      e->beforeRemoveEdge(Edge<E> *); 
-    });
-    RangedGraph<V, E>::removeEdge(Edge<E> *);
-    entanglements->foreachByValue([](RangedGraphEntanglement<V, E> *e) {
-      e->afterRemoveEdge();
+    for (Position<Entanglement *> *e = entanglements.first();
+        e != entanglements.end(); e = e->next) {
+      e->value->beforeRemoveEdge(edge);
+    }
+    RangedGraph<V, E>::removeEdge(edge);
+    for (Position<Entanglement *> *e = entanglements.first();
+        e != entanglements.end(); e = e->next) {
+      e->value->afterRemoveEdge();
     }
   }
 
   void removeVertex(int vertex) {
     ENTANGLEMENT_STACK
-    entanglements->foreachByValue([](RangedGraphEntanglement<V, E> *e) {
-      e->beforeRemoveVertex(vertex); 
-    });
+    for (Position<Entanglement *> *e = entanglements.first();
+        e != entanglements.end(); e = e->next) {
+      e->value->beforeRemoveVertex(vertex);
+    }
     RangedGraph<V, E>::removeVertex(vertex);
-    entanglements->foreachByValue([](RangedGraphEntanglement<V, E> *e) {
-      e->afterRemoveVertex();
+    for (Position<Entanglement *> *e = entanglements.first();
+        e != entanglements.end(); e = e->next) {
+      e->value->afterRemoveVertex();
+    }
+  }
+
+};
+
+/**
+* No-op base for compile-time observers of StaticEntangledRangedGraph.
+*
+* This is the static counterpart of RangedGraphEntanglement.  Observers
+* derive from it and hide only the hooks they care about; everything else
+* resolves to these empty inline functions, which the compiler removes
+* entirely.  Hooks receive the graph they are mixed into.
+*/
+template<class V, class E>
+class RangedGraphObserver {
+  public:
+  void beforeAddEdge(RangedGraph<V, E> &graph, int left, int right,
+      E value) {}
+  void afterAddEdge(RangedGraph<V, E> &graph, Edge<V, E> *edge) {}
+  void beforeRemoveEdge(RangedGraph<V, E> &graph, Edge<V, E> *edge) {}
+  void afterRemoveEdge(RangedGraph<V, E> &graph, int left, int right) {}
+  void beforeRemoveVertex(RangedGraph<V, E> &graph, int vertex) {}
+  void afterRemoveVertex(RangedGraph<V, E> &graph, int vertex) {}
+};
+
+/**
+* Entangled RangedGraph whose observers are fixed at compile time.
+*
+* Each observer type is mixed in as a base class, and every hook is a direct,
+* inlinable call to Observer::hook for each of them in order: there is no
+* list to walk and no virtual call, and hooks an observer does not define
+* compile away.  A graph with an entangled degree queue therefore compiles to
+* the same code as one with the queue updates written in by hand.
+*
+* Observers are reached with observer<O>() or by converting the graph to O&.
+* EntangledRangedGraph remains for observers only known at run time.
+*/
+template<class V, class E, class... Observers>
+class StaticEntangledRangedGraph :
+    public RangedGraph<V, E>,
+    public Observers... {
+  public:
+  StaticEntangledRangedGraph(int bottom, int top,
+      PositionPool<Edge<V, E> *> *pool = nullptr) :
+      RangedGraph<V, E>(bottom, top, pool) {}
+
+  template<class O>
+  O &observer() {
+    return *this;
+  }
+
+  Edge<V, E> *addEdge(int left, int right, E value) {
+    int before[] = {0,
+        (Observers::beforeAddEdge(*this, left, right, value), 0)...};
+    (void) before;
+    Edge<V, E> *newEdge = RangedGraph<V, E>::addEdge(left, right, value);
+    int after[] = {0, (Observers::afterAddEdge(*this, newEdge), 0)...};
+    (void) after;
+    return newEdge;
+  }
+
+  void removeEdge(Edge<V, E> *edge) {
+    int before[] = {0, (Observers::beforeRemoveEdge(*this, edge), 0)...};
+    (void) before;
+    int left = this->keyOf(edge->left);
+    int right = this->keyOf(edge->right);
+    RangedGraph<V, E>::removeEdge(edge);
+    int after[] = {0, (Observers::afterRemoveEdge(*this, left, right), 0)...};
+    (void) after;
+  }
+
+  /**
+  * Removes each edge through this class's removeEdge directly, so the edge
+  * hooks fire without going through RangedGraph's virtual dispatch.
+  */
+  void removeVertex(int vertex) {
+    VC_STAT(verticesRemoved)
+    int before[] = {0, (Observers::beforeRemoveVertex(*this, vertex), 0)...};
+    (void) before;
+    Vertex<V, E> *v = this->bucket(vertex);
+    while (v->size != 0) {
+      StaticEntangledRangedGraph::removeEdge(v->first()->value);
     }
+    int after[] = {0, (Observers::afterRemoveVertex(*this, vertex), 0)...};
+    (void) after;
   }
 
-}
+};
+
+#endif
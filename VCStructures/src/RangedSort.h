@@ -0,0 +1,140 @@
+#ifndef RANGED_SORT__
+#define RANGED_SORT__
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+* Sorting and selection on integer keys, in the spirit of RangedBuckets but
+* with contiguous storage.
+*
+* A RangedBuckets filled with every value and walked bucket by bucket is a
+* counting sort, but every value costs a linked Position.  Here the buckets
+* are flattened: one pass counts the size of each bucket, a prefix sum turns
+* sizes into starting offsets, and a second pass scatters each value straight
+* into its slot of the output array.  Everything is stable.
+*
+* Keys are given by a function of the value, so that edges can be sorted by
+* either endpoint and vertices by degree without copying keys around.
+*/
+
+/**
+* Stable counting sort of n values into out by keys in [bottom, top).
+* O(n + top - bottom).
+*/
+template<class T, class Key>
+void countingSort(const T *in, std::size_t n, T *out, int bottom, int top,
+    Key key) {
+  std::vector<std::size_t> start(top - bottom + 1, 0);
+  for (std::size_t i = 0; i < n; i++) {
+    start[key(in[i]) - bottom + 1]++;
+  }
+  for (std::size_t b = 1; b < start.size(); b++) {
+    start[b] += start[b - 1];
+  }
+  for (std::size_t i = 0; i < n; i++) {
+    out[start[key(in[i]) - bottom]++] = in[i];
+  }
+}
+
+/**
+* Stable LSD radix sort of n values by an unsigned integer key, one byte per
+* pass.  Every byte's histogram is built in a single read of the input, and
+* passes where every key has the same byte are skipped, so keys that only
+* use their low bits (vertex ids, degrees) take fewer passes.
+*
+* @param scratch Room for n values, or null to allocate it here.
+*/
+template<class T, class Key>
+void radixSort(T *values, std::size_t n, Key key, T *scratch = nullptr) {
+  typedef typename std::decay<decltype(key(*values))>::type K;
+  static_assert(std::is_unsigned<K>::value, "radixSort needs unsigned keys");
+  const int passes = sizeof(K);
+  std::vector<std::size_t> counts(passes * 256, 0);
+  for (std::size_t i = 0; i < n; i++) {
+    K k = key(values[i]);
+    for (int pass = 0; pass < passes; pass++) {
+      counts[pass * 256 + ((k >> (8 * pass)) & 0xFF)]++;
+    }
+  }
+  std::vector<T> owned;
+  if (scratch == nullptr && n > 0) {
+    owned.resize(n);
+    scratch = owned.data();
+  }
+  T *from = values;
+  T *to = scratch;
+  for (int pass = 0; pass < passes; pass++) {
+    std::size_t *count = counts.data() + pass * 256;
+    if (n == 0 || count[(key(from[0]) >> (8 * pass)) & 0xFF] == n) {
+      continue;
+    }
+    std::size_t offset = 0;
+    for (int b = 0; b < 256; b++) {
+      std::size_t size = count[b];
+      count[b] = offset;
+      offset += size;
+    }
+    for (std::size_t i = 0; i < n; i++) {
+      to[count[(key(from[i]) >> (8 * pass)) & 0xFF]++] = from[i];
+    }
+    std::swap(from, to);
+  }
+  if (from != values) {
+    for (std::size_t i = 0; i < n; i++) {
+      values[i] = from[i];
+    }
+  }
+}
+
+/**
+* The k values of highest key in [bottom, top), highest first and stable
+* among equal keys.  One counting pass finds the lowest key that makes the
+* cut, and one more collects the values at or above it.  O(n + top - bottom).
+*/
+template<class T, class Key>
+std::vector<T> topK(const T *values, std::size_t n, std::size_t k,
+    int bottom, int top, Key key) {
+  k = k < n ? k : n;
+  std::vector<std::size_t> count(top - bottom, 0);
+  for (std::size_t i = 0; i < n; i++) {
+    count[key(values[i]) - bottom]++;
+  }
+  //Find the cut: every key above threshold is taken, and `room` of the
+  //values at threshold itself.
+  int threshold = top;
+  std::size_t taken = 0;
+  while (taken < k) {
+    threshold--;
+    taken += count[threshold - bottom];
+  }
+  std::size_t room = k - (taken - (threshold < top ?
+      count[threshold - bottom] : 0));
+  //Lay out the kept keys highest first.
+  std::size_t offset = 0;
+  for (int b = top - 1; b >= threshold; b--) {
+    std::size_t size = b == threshold ? room : count[b - bottom];
+    count[b - bottom] = offset;
+    offset += size;
+  }
+  std::vector<T> out(k);
+  for (std::size_t i = 0; i < n; i++) {
+    int b = key(values[i]);
+    if (b < threshold) {
+      continue;
+    }
+    if (b == threshold) {
+      if (room == 0) {
+        continue;
+      }
+      room--;
+    }
+    out[count[b - bottom]++] = values[i];
+  }
+  return out;
+}
+
+#endif
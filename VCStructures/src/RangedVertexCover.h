@@ -0,0 +1,669 @@
+#ifndef RANGED_VERTEX_COVER__
+#define RANGED_VERTEX_COVER__
+
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AdaptableHeap.h"
+#include "CSRRangedGraph.h"
+#include "DegreeQueueEntanglement.h"
+#include "RadixAdaptableHeap.h"
+#include "RangedAdaptablePriorityDeque.h"
+#include "VCStats.h"
+#include "WorkerPool.h"
+
+/**
+* Vertex cover heuristics built on the VCStructures containers.
+*
+* Mirrors the VertexCover interface (solution, value, runtime, iterations and
+* the report functions) but runs on a CSRRangedGraph with a
+* RangedAdaptablePriorityDeque of vertices keyed by degree.  Heuristics
+* remove edges from the graph's deletion overlay as they go; call
+* CSRRangedGraph::restore() to run another one on the same graph.
+*
+* With lazy set, the queue heuristics stop applying every degree decrement
+* to the deque as it happens:
+*   - Max degree keeps each vertex's key as an upper bound on its degree.
+*     Only a vertex that reaches the top bucket is checked against its live
+*     degree, and moved down if it is stale.  Since no key is below its
+*     vertex's degree, a vertex whose key matches at the top is a true maximum.
+*   - Min degree cannot use stale keys (an overestimate could hide the true
+*     minimum), so the decrements of each step are coalesced instead: every
+*     touched vertex is moved once, to its final degree, before the next pop.
+*
+* Queue max degree only needs the top half of the deque, so it can also run
+* on DaryAdaptableHeap or RadixAdaptableHeap, chosen by queueKind.
+*/
+class RangedVertexCover {
+public:
+  const char *hueristic;
+  int value;
+  double runtime;
+  int iterations;
+  std::vector<int> solution;
+  /** Parallel max degree: number of bucket-synchronous rounds. */
+  int rounds;
+
+  /** Whether the queue heuristics defer degree updates. */
+  bool lazy;
+
+  /** Queues queueMaxDegreeApproximation can run on. */
+  enum QueueKind { BUCKET_QUEUE, DARY_HEAP, RADIX_HEAP, ANY_QUEUE };
+
+  /**
+  * Queue for queueMaxDegreeApproximation.  ANY_QUEUE takes buckets unless
+  * the maximum degree reaches the number of vertices queued, which only
+  * parallel edges and loops allow; see chooseQueue.
+  */
+  QueueKind queueKind;
+
+  RangedVertexCover(bool lazy = false, QueueKind queueKind = ANY_QUEUE) :
+      hueristic(""),
+      value(0),
+      runtime(0),
+      iterations(0),
+      rounds(0),
+      lazy(lazy),
+      queueKind(queueKind) {}
+
+  /**
+  * Repeatedly takes a vertex of highest remaining degree into the cover,
+  * found by scanning every vertex.  O(V) per vertex taken; the queue version
+  * gives the same covers much faster and exists mostly for comparison.
+  */
+  void maxDegreeApproximation(CSRRangedGraph *g) {
+    begin("Max Degree");
+    Clock::time_point start = Clock::now();
+    while (g->edgeCount > 0) {
+      maxDegreeIteration(g);
+    }
+    finish(start);
+  }
+
+  /**
+  * Repeatedly takes every neighbor of a vertex of lowest remaining degree
+  * into the cover, found by scanning every vertex.
+  */
+  void minDegreeApproximation(CSRRangedGraph *g) {
+    begin("Min Degree");
+    Clock::time_point start = Clock::now();
+    while (g->edgeCount > 0) {
+      minDegreeIteration(g);
+    }
+    finish(start);
+  }
+
+  /**
+  * Repeatedly takes a vertex of highest remaining degree into the cover.
+  */
+  void queueMaxDegreeApproximation(CSRRangedGraph *g) {
+    Clock::time_point start = Clock::now();
+    int maxDegree = maxDegreeOf(g);
+    switch (chooseQueue(g, maxDegree)) {
+      case DARY_HEAP: {
+        begin(lazy ? "Lazy Heap Max Degree" : "Heap Max Degree");
+        DaryAdaptableHeap<int> heap(0, maxDegree + 1, g->vertices);
+        std::vector<DaryAdaptableHeap<int>::Handle> handles;
+        fillVertexHeap(g, &heap, handles);
+        while (g->edgeCount > 0) {
+          queueMaxDegreeIteration(g, &heap, handles);
+        }
+        break;
+      }
+      case RADIX_HEAP: {
+        begin(lazy ? "Lazy Radix Heap Max Degree" : "Radix Heap Max Degree");
+        RadixAdaptableHeap<int> heap(0, maxDegree + 1);
+        std::vector<RadixAdaptableHeap<int>::Handle> handles;
+        fillVertexHeap(g, &heap, handles);
+        while (g->edgeCount > 0) {
+          queueMaxDegreeIteration(g, &heap, handles);
+        }
+        break;
+      }
+      default:
+        begin(lazy ? "Lazy Queue Max Degree" : "Queue Max Degree");
+        createVertexHeap(g);
+        while (g->edgeCount > 0) {
+          queueMaxDegreeIteration(g, queue, positions);
+        }
+    }
+    finish(start);
+  }
+
+  /**
+  * Repeatedly takes every neighbor of a vertex of lowest remaining degree
+  * into the cover.
+  */
+  void queueMinDegreeApproximation(CSRRangedGraph *g) {
+    begin(lazy ? "Lazy Queue Min Degree" : "Queue Min Degree");
+    Clock::time_point start = Clock::now();
+    createVertexHeap(g);
+    inCover.assign(g->vertices, 0);
+    while (g->edgeCount > 0) {
+      queueMinDegreeIteration(g);
+    }
+    finish(start);
+  }
+
+  /**
+  * Max degree over a RangedGraph whose degree queue is already maintained
+  * by a DegreeQueueEntanglement or DegreeQueueObserver, so there is no queue
+  * to build: each vertex taken is removed through the graph, whose hooks
+  * move its neighbors down.  Like the VertexCover heuristics, this consumes
+  * the graph's edges.
+  *
+  * @param g The entangled graph, as the type whose removeVertex fires the
+  * hooks.
+  */
+  template<class G, class V, class E>
+  void entangledMaxDegreeApproximation(G *g, DegreeIndex<V, E> *index) {
+    begin("Entangled Queue Max Degree");
+    Clock::time_point start = Clock::now();
+    while (g->edgeCount > 0) {
+      iterations++;
+      int vertex = index->queue->peepTop();
+      solution.push_back(vertex);
+      g->removeVertex(vertex);
+    }
+    finish(start);
+  }
+
+  /**
+  * Takes both ends of every edge of a greedy maximal matching, scanning
+  * edges in id order.  Leaves the graph untouched, but skips edges already
+  * removed from it.
+  */
+  void twoApproximation(CSRRangedGraph *g) {
+    begin("Two Approximation");
+    Clock::time_point start = Clock::now();
+    std::vector<char> matched(g->vertices, 0);
+    for (std::size_t edge = 0; edge < g->edges; edge++) {
+      iterations++;
+      int left = g->endpoints[edge].left - g->bottomVertex;
+      int right = g->endpoints[edge].right - g->bottomVertex;
+      if (g->isRemoved(edge) || matched[left] || matched[right]) {
+        continue;
+      }
+      matched[left] = 1;
+      matched[right] = 1;
+      solution.push_back(g->endpoints[edge].left);
+      if (left != right) {
+        solution.push_back(g->endpoints[edge].right);
+      }
+    }
+    finish(start);
+  }
+
+  /**
+  * Multi-threaded twoApproximation.  Edges are split into one contiguous
+  * range per thread, and each thread matches an edge by claiming both of its
+  * endpoints through a per-vertex atomic flag:
+  *   FREE -> CLAIMED by compare-and-swap, lower vertex first, then
+  *   CLAIMED -> MATCHED on both once both are held.
+  * If the second claim finds a MATCHED vertex the first is set back to FREE
+  * and the edge is skipped; if it finds a CLAIMED one it waits, which is
+  * brief and cannot deadlock because every thread claims in the same order.
+  * An edge is therefore only skipped when an endpoint is matched for good,
+  * so the result is a maximal matching, and the cover is within a factor of
+  * two of optimal like the serial version.  Which matching is found depends
+  * on thread timing.
+  *
+  * @param threads Number of threads, or 0 for one per hardware thread.
+  */
+  void parallelTwoApproximation(CSRRangedGraph *g, unsigned threads = 0) {
+    begin("Parallel Two Approximation");
+    Clock::time_point start = Clock::now();
+    if (threads == 0) {
+      threads = std::thread::hardware_concurrency();
+      threads = threads == 0 ? 1 : threads;
+    }
+    std::unique_ptr<std::atomic<std::uint8_t>[]> state(
+        new std::atomic<std::uint8_t>[g->vertices]());
+    std::vector<std::vector<int>> covers(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+      std::size_t first = g->edges * t / threads;
+      std::size_t last = g->edges * (t + 1) / threads;
+      workers.push_back(std::thread([=, &state, &covers]() {
+        matchEdges(g, state.get(), first, last, covers[t]);
+      }));
+    }
+    for (std::thread &worker : workers) {
+      worker.join();
+    }
+    for (std::vector<int> &cover : covers) {
+      solution.insert(solution.end(), cover.begin(), cover.end());
+    }
+    iterations = (int) g->edges;
+    finish(start);
+  }
+
+  /**
+  * Parallel counterpart to queueMaxDegreeApproximation, in bucket-synchronous
+  * rounds.  Each round looks at the whole top bucket of the degree queue and
+  * takes every vertex in it that has no neighbor in that bucket with a
+  * smaller id.  That subset is independent, so every vertex taken still had
+  * the maximum degree when taken, and the lowest id in the bucket is always
+  * taken, so each round makes progress.
+  *
+  * Threads split the taken vertices and flag their edges removed through
+  * CSRRangedGraph::markRemoved.  Each edge belongs to exactly one taken
+  * vertex, so this needs no synchronization; the flagged edges go into one
+  * buffer per thread.  The buffers are then settled into the graph's
+  * degrees and each touched vertex is moved once in the queue.  The threads
+  * are started once per call and wait in a WorkerPool between steps.
+  *
+  * The cover can differ from the serial one because ties within a bucket
+  * are broken by id and taken together; see reportComparison.
+  *
+  * @param threads Number of threads, or 0 for one per hardware thread.
+  */
+  void parallelMaxDegreeApproximation(CSRRangedGraph *g,
+      unsigned threads = 0) {
+    begin("Parallel Max Degree");
+    Clock::time_point start = Clock::now();
+    if (threads == 0) {
+      threads = std::thread::hardware_concurrency();
+      threads = threads == 0 ? 1 : threads;
+    }
+    createVertexHeap(g);
+    WorkerPool pool(threads);
+    std::vector<char> inRound(g->vertices, 0);
+    std::vector<int> round;
+    std::vector<char> keep;
+    std::vector<int> picked;
+    std::vector<std::vector<std::uint32_t>> buffers(threads);
+    while (g->edgeCount > 0) {
+      rounds++;
+      BucketPositionalList<Empty, int> *top = queue->bucket(queue->topKey());
+      round.clear();
+      for (Position<int> *p = top->first(); p != top->end(); p = p->next) {
+        round.push_back(p->value);
+        inRound[p->value - g->bottomVertex] = 1;
+      }
+
+      keep.assign(round.size(), 1);
+      parallelFor(pool, round.size(), [&](std::size_t i, unsigned) {
+        int vertex = round[i];
+        for (const CSRIncidence *j = g->begin(vertex), *e = g->end(vertex);
+            j != e; j++) {
+          if (g->removed[j->edge] == 0 && j->neighbor < vertex &&
+              inRound[j->neighbor - g->bottomVertex]) {
+            keep[i] = 0;
+            return;
+          }
+        }
+      });
+      picked.clear();
+      for (std::size_t i = 0; i < round.size(); i++) {
+        inRound[round[i] - g->bottomVertex] = 0;
+        if (keep[i]) {
+          picked.push_back(round[i]);
+          Position<int> *&p = positions[round[i] - g->bottomVertex];
+          queue->eliminate(p);
+          p = nullptr;
+          solution.push_back(round[i]);
+          iterations++;
+        }
+      }
+
+      parallelFor(pool, picked.size(), [&](std::size_t i, unsigned t) {
+        int vertex = picked[i];
+        for (const CSRIncidence *j = g->begin(vertex), *e = g->end(vertex);
+            j != e; j++) {
+          if (g->markRemoved(j->edge)) {
+            buffers[t].push_back(j->edge);
+          }
+        }
+      });
+      for (std::vector<std::uint32_t> &buffer : buffers) {
+        for (std::uint32_t edge : buffer) {
+          g->settleRemoved(edge);
+          //Taken vertices have left the queue, so reconcile skips them.
+          touched.push_back(g->endpoints[edge].left);
+          touched.push_back(g->endpoints[edge].right);
+        }
+        buffer.clear();
+      }
+      for (int vertex : touched) {
+        reconcile(g, queue, positions, vertex);
+      }
+      touched.clear();
+    }
+    finish(start);
+  }
+
+  /**
+  * Prints this run next to another, typically a serial run on the same
+  * graph, with the ratio of their cover sizes.
+  */
+  void reportComparison(RangedVertexCover &other) {
+    report();
+    other.report();
+    printf("  cover ratio %s / %s: %.4f\n", hueristic, other.hueristic,
+        other.value == 0 ? 1.0 : (double) value / other.value);
+  }
+
+  void report() {
+    printf("%s: %d vertices in %.3f ms\n", hueristic, value, runtime);
+  }
+
+  void reportExtended() {
+    report();
+    printf("  iterations: %d\n", iterations);
+    if (rounds > 0) {
+      printf("  rounds: %d\n", rounds);
+    }
+#ifdef VC_STATS
+    VCStats::global().print();
+#endif
+  }
+
+  void reportFull() {
+    reportExtended();
+    printf("  cover:");
+    for (int vertex : solution) {
+      printf(" %d", vertex);
+    }
+    printf("\n");
+  }
+
+private:
+  typedef RangedAdaptablePriorityDeque<int> VertexHeap;
+  typedef std::chrono::steady_clock Clock;
+
+  VertexHeap *queue = nullptr;
+  /** Each vertex's position in queue, or null once it has left. */
+  std::vector<Position<int> *> positions;
+  /** Min degree: vertices already taken into the cover. */
+  std::vector<char> inCover;
+  /** Vertices whose degree changed during the current step. */
+  std::vector<int> touched;
+
+  void begin(const char *name) {
+    hueristic = name;
+    value = 0;
+    runtime = 0;
+    iterations = 0;
+    rounds = 0;
+    solution.clear();
+    VCStats::global().reset();
+  }
+
+  void finish(Clock::time_point start) {
+    delete queue;
+    queue = nullptr;
+    value = (int) solution.size();
+    runtime = convertToMs(start, Clock::now());
+  }
+
+  /**
+  * Wall clock rather than clock(), which would add up the CPU time of every
+  * thread in the parallel heuristics.
+  */
+  double convertToMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+  }
+
+  int maxDegreeOf(CSRRangedGraph *g) {
+    int maxDegree = 0;
+    for (int v = g->bottomVertex; v < g->topVertex; v++) {
+      maxDegree = g->degree(v) > maxDegree ? g->degree(v) : maxDegree;
+    }
+    return maxDegree;
+  }
+
+  /** Vertices queued above which ANY_QUEUE prefers the d-ary heap. */
+  static const std::size_t RADIX_MAX_QUEUED = 8192;
+
+  /**
+  * Resolves ANY_QUEUE from the maximum degree and the number of vertices
+  * queued, the two sizes the queues' costs depend on.
+  *
+  * Without parallel edges or loops the maximum degree is below the number
+  * queued.  There the cover benchmarks have buckets as fast as either heap,
+  * and their first-in first-out ties give smaller covers on regular graphs
+  * such as grids, so buckets are taken.
+  *
+  * A multigraph can reach past that, and each vertex then sees many
+  * decrements of one.  Measured on skewed multigraphs with maxDegree from
+  * one to a few hundred times the number queued, both heaps beat buckets
+  * by up to 30%.  The radix heap is fastest up to a few thousand vertices
+  * queued and the d-ary heap beyond, where refiling the radix buckets
+  * stops fitting in cache.
+  */
+  QueueKind chooseQueue(CSRRangedGraph *g, int maxDegree) {
+    if (queueKind != ANY_QUEUE) {
+      return queueKind;
+    }
+    std::size_t queued = 0;
+    for (int v = g->bottomVertex; v < g->topVertex; v++) {
+      queued += g->degree(v) > 0;
+    }
+    if ((std::size_t) maxDegree < queued) {
+      return BUCKET_QUEUE;
+    }
+    return queued > RADIX_MAX_QUEUED ? DARY_HEAP : RADIX_HEAP;
+  }
+
+  /**
+  * Queues every vertex with at least one edge, keyed by degree.
+  */
+  void createVertexHeap(CSRRangedGraph *g) {
+    int maxDegree = maxDegreeOf(g);
+    delete queue;
+    queue = new VertexHeap(0, maxDegree + 1);
+    fillVertexHeap(g, queue, positions);
+  }
+
+  template<class Q>
+  void fillVertexHeap(CSRRangedGraph *g, Q *q,
+      std::vector<typename Q::Handle> &handles) {
+    handles.assign(g->vertices, nullptr);
+    for (int v = g->bottomVertex; v < g->topVertex; v++) {
+      if (g->degree(v) > 0) {
+        handles[v - g->bottomVertex] = q->add(g->degree(v), v);
+      }
+    }
+  }
+
+  /**
+  * Brings a vertex's key in line with its live degree, dropping it from the
+  * queue once it has no edges left.
+  */
+  template<class Q>
+  void reconcile(CSRRangedGraph *g, Q *q,
+      std::vector<typename Q::Handle> &handles, int vertex) {
+    typename Q::Handle &p = handles[vertex - g->bottomVertex];
+    if (p == nullptr) {
+      return;
+    }
+    int degree = g->degree(vertex);
+    if (degree == 0) {
+      q->eliminate(p);
+      p = nullptr;
+    } else if (q->keyOf(p) != degree) {
+      q->adapt(p, degree);
+    }
+  }
+
+  /**
+  * Takes a vertex into the cover and removes its edges.  Eagerly, every
+  * neighbor is reconciled after each edge; otherwise neighbors are only
+  * remembered in touched.
+  */
+  template<class Q>
+  void take(CSRRangedGraph *g, Q *q, std::vector<typename Q::Handle> &handles,
+      int vertex) {
+    typename Q::Handle &p = handles[vertex - g->bottomVertex];
+    if (p != nullptr) {
+      q->eliminate(p);
+      p = nullptr;
+    }
+    solution.push_back(vertex);
+    for (const CSRIncidence *i = g->begin(vertex), *e = g->end(vertex);
+        i != e; i++) {
+      if (g->isRemoved(i->edge)) {
+        continue;
+      }
+      g->removeEdge(i->edge);
+      if (lazy) {
+        touched.push_back(i->neighbor);
+      } else {
+        reconcile(g, q, handles, i->neighbor);
+      }
+    }
+  }
+
+  /**
+  * Runs body(i, thread) for every i in [0, count), split into one contiguous
+  * block per thread of the pool.  Small ranges run on the calling thread,
+  * where waking the pool would cost more than the work.
+  */
+  template<class F>
+  static void parallelFor(WorkerPool &pool, std::size_t count, F body) {
+    unsigned threads = pool.threads;
+    if (threads <= 1 || count < 64 * (std::size_t) threads) {
+      for (std::size_t i = 0; i < count; i++) {
+        body(i, 0);
+      }
+      return;
+    }
+    auto block = [&](unsigned t) {
+      for (std::size_t i = count * t / threads;
+          i < count * (t + 1) / threads; i++) {
+        body(i, t);
+      }
+    };
+    pool.run(block);
+  }
+
+  enum MatchState : std::uint8_t { FREE = 0, CLAIMED = 1, MATCHED = 2 };
+
+  /**
+  * Moves a vertex from FREE to CLAIMED, waiting out other claims.
+  * @return False if the vertex is already matched.
+  */
+  static bool claim(std::atomic<std::uint8_t> &flag) {
+    for (;;) {
+      std::uint8_t expected = FREE;
+      if (flag.compare_exchange_weak(expected, CLAIMED,
+          std::memory_order_acquire, std::memory_order_relaxed)) {
+        return true;
+      }
+      if (expected == MATCHED) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  static void matchEdges(CSRRangedGraph *g, std::atomic<std::uint8_t> *state,
+      std::size_t first, std::size_t last, std::vector<int> &cover) {
+    for (std::size_t edge = first; edge < last; edge++) {
+      if (g->removed[edge] != 0) {
+        continue;
+      }
+      int left = g->endpoints[edge].left;
+      int right = g->endpoints[edge].right;
+      std::atomic<std::uint8_t> &low =
+          state[(left < right ? left : right) - g->bottomVertex];
+      std::atomic<std::uint8_t> &high =
+          state[(left < right ? right : left) - g->bottomVertex];
+      if (low.load(std::memory_order_relaxed) == MATCHED ||
+          high.load(std::memory_order_relaxed) == MATCHED) {
+        continue;
+      }
+      if (!claim(low)) {
+        continue;
+      }
+      if (&high != &low && !claim(high)) {
+        low.store(FREE, std::memory_order_release);
+        continue;
+      }
+      low.store(MATCHED, std::memory_order_release);
+      high.store(MATCHED, std::memory_order_release);
+      cover.push_back(left);
+      if (left != right) {
+        cover.push_back(right);
+      }
+    }
+  }
+
+  void maxDegreeIteration(CSRRangedGraph *g) {
+    iterations++;
+    int best = g->bottomVertex;
+    for (int v = g->bottomVertex; v < g->topVertex; v++) {
+      if (g->degree(v) > g->degree(best)) {
+        best = v;
+      }
+    }
+    solution.push_back(best);
+    g->removeVertex(best);
+  }
+
+  void minDegreeIteration(CSRRangedGraph *g) {
+    iterations++;
+    int best = g->bottomVertex - 1;
+    for (int v = g->bottomVertex; v < g->topVertex; v++) {
+      int degree = g->degree(v);
+      if (degree > 0 && (best < g->bottomVertex || degree < g->degree(best))) {
+        best = v;
+      }
+    }
+    for (const CSRIncidence *i = g->begin(best), *e = g->end(best); i != e;
+        i++) {
+      if (!g->isRemoved(i->edge)) {
+        solution.push_back(i->neighbor);
+        g->removeVertex(i->neighbor);
+      }
+    }
+  }
+
+  template<class Q>
+  void queueMaxDegreeIteration(CSRRangedGraph *g, Q *q,
+      std::vector<typename Q::Handle> &handles) {
+    iterations++;
+    if (!lazy) {
+      take(g, q, handles, q->peepTop());
+      return;
+    }
+    //Keys only overestimate degrees, so settle stale tops until one holds.
+    for (;;) {
+      int vertex = q->peepTop();
+      if (q->keyOf(handles[vertex - g->bottomVertex]) == g->degree(vertex)) {
+        take(g, q, handles, vertex);
+        touched.clear();
+        return;
+      }
+      reconcile(g, q, handles, vertex);
+    }
+  }
+
+  void queueMinDegreeIteration(CSRRangedGraph *g) {
+    iterations++;
+    int vertex = queue->peepBottom();
+    for (const CSRIncidence *i = g->begin(vertex), *e = g->end(vertex);
+        i != e; i++) {
+      int neighbor = i->neighbor;
+      if (g->isRemoved(i->edge) || inCover[neighbor - g->bottomVertex]) {
+        continue;
+      }
+      inCover[neighbor - g->bottomVertex] = 1;
+      take(g, queue, positions, neighbor);
+    }
+    for (int touchedVertex : touched) {
+      reconcile(g, queue, positions, touchedVertex);
+    }
+    touched.clear();
+  }
+
+};
+
+#endif
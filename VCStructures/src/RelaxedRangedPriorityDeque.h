@@ -0,0 +1,183 @@
+#ifndef RELAXED_RANGED_PRIORITY_DEQUE__
+#define RELAXED_RANGED_PRIORITY_DEQUE__
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentRangedBuckets.h"
+
+/**
+* MultiQueue-style relaxed priority deque over ConcurrentRangedBuckets.
+*
+* Values are spread at random over k shards, each a ConcurrentRangedBuckets
+* of the full key range.  A pop samples two shards, compares their extreme
+* keys without locking, and pops from the better one.  Threads therefore
+* contend on k top buckets instead of one, at the cost of order: a pop may
+* return a value that is not the true maximum (or minimum).  With two
+* choices the expected rank error (number of better values left behind) is
+* O(k) and, for a fixed k, does not grow with the number of values.
+*
+* With one shard this is a ConcurrentRangedBuckets with exact pops.
+*/
+template<class P>
+class RelaxedRangedPriorityDeque {
+  public:
+  typedef ConcurrentRangedBuckets<P> Shard;
+
+  struct Handle {
+    Shard *shard;
+    typename Shard::Handle node;
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards;
+
+  /**
+  * @param bottom The lowest valid key.
+  * @param top The highest valid key plus one.
+  * @param capacity Maximum number of values added before clear().
+  * @param k Number of shards; 0 picks twice the hardware thread count.
+  */
+  RelaxedRangedPriorityDeque(int bottom, int top, std::size_t capacity,
+      unsigned k = 0) {
+    if (k == 0) {
+      k = 2 * std::thread::hardware_concurrency();
+      k = k == 0 ? 2 : k;
+    }
+    //Adds pick a shard at random, so leave some slack over an even split.
+    std::size_t shardCapacity = capacity / k + capacity / (4 * k) + 64;
+    for (unsigned i = 0; i < k; i++) {
+      shards.emplace_back(new Shard(bottom, top, shardCapacity));
+    }
+  }
+
+  void error() {
+    exit(1);
+  }
+
+  std::size_t size() {
+    std::size_t total = 0;
+    for (std::unique_ptr<Shard> &shard : shards) {
+      total += shard->size();
+    }
+    return total;
+  }
+
+  /**
+  * Adds a value to a random shard, or the next one with room left.
+  */
+  Handle add(int key, P value) {
+    std::size_t first = random() % shards.size();
+    for (std::size_t i = 0; i < shards.size(); i++) {
+      Shard *shard = shards[(first + i) % shards.size()].get();
+      typename Shard::Handle node = shard->tryAdd(key, value);
+      if (node != nullptr) {
+        return Handle{shard, node};
+      }
+    }
+    error();
+    return Handle{nullptr, nullptr};
+  }
+
+  /**
+  * @return False if the value was already removed or popped.
+  */
+  bool remove(Handle handle) {
+    return handle.shard->remove(handle.node);
+  }
+
+  /**
+  * Changes a value's key within its shard.
+  * @return False if the value was already removed or popped.
+  */
+  bool adapt(Handle handle, int key) {
+    return handle.shard->move(handle.node, key);
+  }
+
+  int keyOf(Handle handle) {
+    return handle.shard->keyOf(handle.node);
+  }
+
+  /**
+  * Pops a value of high, but not necessarily highest, key.
+  * @return False if every shard is empty.
+  */
+  bool popTop(P &value) {
+    return pop(value, true);
+  }
+
+  /**
+  * Pops a value of low, but not necessarily lowest, key.
+  * @return False if every shard is empty.
+  */
+  bool popBottom(P &value) {
+    return pop(value, false);
+  }
+
+  /**
+  * Not thread-safe: every handle is invalidated.
+  */
+  void clear() {
+    for (std::unique_ptr<Shard> &shard : shards) {
+      shard->clear();
+    }
+  }
+
+  private:
+  /**
+  * Per-thread generator, so that sampling shards needs no shared state.
+  */
+  static std::uint64_t random() {
+    thread_local std::uint64_t state =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    //xorshift64
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  /**
+  * Two sampled shards are tried first.  Once both come up empty, every
+  * shard is swept in turn, so a false return means they were all seen
+  * empty.
+  */
+  bool pop(P &value, bool top) {
+    std::size_t k = shards.size();
+    for (int attempt = 0; attempt < 2; attempt++) {
+      Shard *a = shards[random() % k].get();
+      Shard *b = shards[random() % k].get();
+      int keyA = top ? a->topKey() : a->bottomKey();
+      int keyB = top ? b->topKey() : b->bottomKey();
+      bool aEmpty = keyA < a->bottomBucket || keyA > a->topBucket;
+      bool bEmpty = keyB < b->bottomBucket || keyB > b->topBucket;
+      if (aEmpty && bEmpty) {
+        continue;
+      }
+      Shard *best;
+      if (aEmpty || bEmpty) {
+        best = aEmpty ? b : a;
+      } else {
+        best = (top ? keyA >= keyB : keyA <= keyB) ? a : b;
+      }
+      if (top ? best->popTop(value) : best->popBottom(value)) {
+        return true;
+      }
+    }
+    std::size_t first = random() % k;
+    for (std::size_t i = 0; i < k; i++) {
+      Shard *shard = shards[(first + i) % k].get();
+      if (top ? shard->popTop(value) : shard->popBottom(value)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+#endif
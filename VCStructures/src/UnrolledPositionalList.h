@@ -0,0 +1,295 @@
+#ifndef UNROLLED_POSITIONAL_LIST__
+#define UNROLLED_POSITIONAL_LIST__
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename T>
+struct UnrolledChunk;
+
+/**
+* Stable handle to a value in an UnrolledPositionalList: where the value
+* currently lives.  The list keeps it up to date as values move, so the
+* handle itself never changes.
+*/
+template <typename T>
+struct UnrolledSlot {
+  UnrolledChunk<T> *chunk;
+  unsigned index;
+};
+
+/**
+* A node of an UnrolledPositionalList.  Values are packed at the front, and
+* slots[i] is the handle of values[i].  By default a chunk holds a cache
+* line's worth of values.
+*/
+template <typename T>
+struct UnrolledChunk {
+  static const unsigned CAPACITY = sizeof(T) >= 64 ? 1 : 64 / sizeof(T);
+
+  T values[CAPACITY];
+  UnrolledSlot<T> *slots[CAPACITY];
+  UnrolledChunk<T> *next;
+  UnrolledChunk<T> *previous;
+  unsigned count;
+};
+
+/**
+* Slab allocator for the chunks and slots of UnrolledPositionalLists, the
+* counterpart of PositionPool.  May be shared by any number of lists.
+*/
+template <typename T>
+class UnrolledPool {
+  public:
+  typedef UnrolledChunk<T> Chunk;
+  typedef UnrolledSlot<T> Slot;
+
+  UnrolledPool(std::size_t slabSize = 256) :
+      chunks(slabSize),
+      slots(slabSize * Chunk::CAPACITY) {}
+
+  Chunk *createChunk() {
+    Chunk *chunk = chunks.allocate();
+    chunk->next = nullptr;
+    chunk->previous = nullptr;
+    chunk->count = 0;
+    return chunk;
+  }
+
+  void destroyChunk(Chunk *chunk) {
+    chunks.free(chunk);
+  }
+
+  Slot *createSlot() {
+    return slots.allocate();
+  }
+
+  void destroySlot(Slot *slot) {
+    slots.free(slot);
+  }
+
+  /**
+  * Frees every slab at once, invalidating every list drawing on this pool.
+  */
+  void release() {
+    chunks.release();
+    slots.release();
+  }
+
+  private:
+  /**
+  * Nodes carved out of slabs, with freed nodes reused first.  Freed nodes
+  * are kept on a stack rather than overlaid with a link, since a chunk's
+  * values stay constructed for as long as its slab lives.
+  */
+  template <typename N>
+  class Slabs {
+    public:
+    Slabs(std::size_t slabSize) :
+        slabSize(slabSize == 0 ? 1 : slabSize),
+        used(this->slabSize) {}
+
+    ~Slabs() {
+      release();
+    }
+
+    N *allocate() {
+      if (!freed.empty()) {
+        N *n = freed.back();
+        freed.pop_back();
+        return n;
+      }
+      if (used == slabSize) {
+        slabs.push_back(new N[slabSize]);
+        used = 0;
+      }
+      return slabs.back() + used++;
+    }
+
+    void free(N *n) {
+      freed.push_back(n);
+    }
+
+    void release() {
+      for (N *slab : slabs) {
+        delete[] slab;
+      }
+      slabs.clear();
+      freed.clear();
+      used = slabSize;
+    }
+
+    private:
+    std::size_t slabSize;
+    std::size_t used;
+    std::vector<N *> slabs;
+    std::vector<N *> freed;
+  };
+
+  Slabs<Chunk> chunks;
+  Slabs<Slot> slots;
+};
+
+/**
+* Unrolled counterpart to PositionalList: values are stored a chunk at a
+* time rather than one per node, so walking the list reads whole cache lines
+* of values instead of chasing one pointer per value.
+*
+* Every chunk but the last is kept full.  Removing a value moves the very
+* last value of the list into the hole, so there are never gaps to skip, at
+* the price of the list being unordered: it behaves as a bag, which is all a
+* bucket or an adjacency list needs.  Handles stay valid regardless, since
+* the moved value's UnrolledSlot is updated to its new place.
+*
+* Values must be default constructible and assignable; removed values are
+* overwritten rather than destroyed.
+*/
+template <typename T>
+class UnrolledPositionalList {
+  public:
+  typedef UnrolledChunk<T> Chunk;
+  typedef UnrolledSlot<T> Slot;
+
+  int size;
+  Chunk *head;
+  Chunk *tail;
+  UnrolledPool<T> *pool;
+
+  /**
+  * @param pool Pool to draw chunks and slots from.  There is no private
+  * default: a pool's first slab alone outweighs a short list, so lists are
+  * meant to share one, as the adjacency lists of an UnrolledRangedGraph do.
+  */
+  UnrolledPositionalList(UnrolledPool<T> *pool) :
+      size(0),
+      head(nullptr),
+      tail(nullptr),
+      pool(pool) {}
+
+  /**
+  * Like pooled PositionalLists, lists leave their nodes to the pool's owner,
+  * and touch nothing: the pool may already have been released, or destroyed
+  * along with its owner.  Call clear first to hand the nodes back for reuse.
+  */
+  ~UnrolledPositionalList() {}
+
+  UnrolledPositionalList(const UnrolledPositionalList &) = delete;
+  UnrolledPositionalList &operator=(const UnrolledPositionalList &) = delete;
+
+  T &value(Slot *slot) {
+    return slot->chunk->values[slot->index];
+  }
+
+  /**
+  * Handle of the last value, or null if empty.  Removing it never moves
+  * another value, so draining a list from the back stays sequential.
+  */
+  Slot *last() {
+    return tail == nullptr ? nullptr : tail->slots[tail->count - 1];
+  }
+
+  /**
+  * The last value, read without going through its handle.  The list must
+  * not be empty.
+  */
+  T &back() {
+    return tail->values[tail->count - 1];
+  }
+
+  Slot *addLast(T value) {
+    return addLast(value, pool->createSlot());
+  }
+
+  /**
+  * Like addLast, but fills in a slot owned by the caller, for instance one
+  * embedded in the value it refers to, rather than one from the pool.  Such
+  * a value must be taken out with detach, and the list must not be cleared
+  * while it holds one.
+  */
+  Slot *addLast(T value, Slot *slot) {
+    if (tail == nullptr || tail->count == Chunk::CAPACITY) {
+      Chunk *chunk = pool->createChunk();
+      chunk->previous = tail;
+      if (tail != nullptr) {
+        tail->next = chunk;
+      } else {
+        head = chunk;
+      }
+      tail = chunk;
+    }
+    slot->chunk = tail;
+    slot->index = tail->count;
+    tail->values[tail->count] = value;
+    tail->slots[tail->count] = slot;
+    tail->count++;
+    size++;
+    return slot;
+  }
+
+  /**
+  * Removes a value, filling its place with the last value of the list.
+  */
+  void remove(Slot *slot) {
+    detach(slot);
+    pool->destroySlot(slot);
+  }
+
+  /**
+  * Like remove, but leaves the slot to its owner.
+  */
+  void detach(Slot *slot) {
+    Chunk *chunk = slot->chunk;
+    unsigned index = slot->index;
+    unsigned last = tail->count - 1;
+    if (chunk != tail || index != last) {
+      chunk->values[index] = std::move(tail->values[last]);
+      Slot *moved = tail->slots[last];
+      chunk->slots[index] = moved;
+      moved->chunk = chunk;
+      moved->index = index;
+    }
+    if (--tail->count == 0) {
+      Chunk *empty = tail;
+      tail = tail->previous;
+      if (tail != nullptr) {
+        tail->next = nullptr;
+      } else {
+        head = nullptr;
+      }
+      pool->destroyChunk(empty);
+    }
+    size--;
+  }
+
+  /**
+  * Removes every value, returning the nodes to the pool.
+  */
+  void clear() {
+    while (head != nullptr) {
+      Chunk *next = head->next;
+      for (unsigned i = 0; i < head->count; i++) {
+        pool->destroySlot(head->slots[i]);
+      }
+      pool->destroyChunk(head);
+      head = next;
+    }
+    tail = nullptr;
+    size = 0;
+  }
+
+  /**
+  * Applies a function to a reference to each value, chunk by chunk.  The
+  * list must not be modified meanwhile.
+  */
+  template <typename F>
+  void foreach(F apply) {
+    for (Chunk *chunk = head; chunk != nullptr; chunk = chunk->next) {
+      for (unsigned i = 0; i < chunk->count; i++) {
+        apply(chunk->values[i]);
+      }
+    }
+  }
+};
+
+#endif
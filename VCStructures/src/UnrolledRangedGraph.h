@@ -0,0 +1,212 @@
+#ifndef UNROLLED_RANGED_GRAPH__
+#define UNROLLED_RANGED_GRAPH__
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "UnrolledPositionalList.h"
+#include "VCStats.h"
+
+template<class E>
+class UnrolledEdge;
+
+/**
+* One entry of a vertex's adjacency list.  The neighbor is stored inline so
+* that scanning neighbors never has to touch the edges themselves.
+*/
+template<class E>
+struct UnrolledIncidence {
+  int neighbor;
+  UnrolledEdge<E> *edge;
+};
+
+/**
+* An edge of an UnrolledRangedGraph.  Besides its endpoints it holds the
+* handles of its entries in both endpoints' adjacency lists, inline, so that
+* finding an entry costs no further miss once the edge has been read.
+*/
+template<class E>
+class UnrolledEdge {
+  public:
+  E value;
+  int left;
+  int right;
+  UnrolledSlot<UnrolledIncidence<E>> leftSlot;
+  UnrolledSlot<UnrolledIncidence<E>> rightSlot;
+};
+
+template<class V, class E>
+class UnrolledVertex {
+  public:
+  V value;
+  UnrolledPositionalList<UnrolledIncidence<E>> adjacency;
+
+  UnrolledVertex(UnrolledPool<UnrolledIncidence<E>> *pool) :
+      value(),
+      adjacency(pool) {}
+
+  int degree() const {
+    return adjacency.size;
+  }
+};
+
+/**
+* RangedGraph with unrolled adjacency lists.
+*
+* Every vertex keeps its incidences in an UnrolledPositionalList, and all
+* of those lists draw their chunks from one pool owned by the graph, so an
+* isolated vertex costs a list header and nothing more.  Each edge embeds
+* the slots of its two incidences, which the lists keep up to date as values
+* move, so removing an edge is O(1) as in RangedGraph; but neighbor scans
+* read whole chunks of incidences rather than one node per edge.
+*
+* Adjacency order is not preserved by removals.  removeVertex takes edges
+* from the back of the vertex's own list, which never moves a value, so a
+* high-degree vertex is drained chunk by chunk and only the neighbors' lists
+* see random accesses.  Those cost about as much as in RangedGraph, and the
+* handle each chunk keeps per incidence makes the graph larger than an
+* ArrayRangedGraph, which stays the cheaper choice when removals dominate.
+*
+* Edges are carved out of slabs and recycled, as in ArrayRangedGraph, so an
+* edge pointer is valid until that edge is removed.
+*/
+template<class V, class E>
+class UnrolledRangedGraph {
+  public:
+  typedef UnrolledEdge<E> Edge;
+  typedef UnrolledVertex<V, E> Vertex;
+  typedef UnrolledIncidence<E> Incidence;
+
+  /** Index of the top valid vertex. */
+  int topBucket;
+  /** Index of the bottom valid vertex. */
+  int bottomBucket;
+  /** Number of vertices. */
+  std::size_t buckets;
+  int edgeCount;
+
+  UnrolledRangedGraph(int bottom, int top) :
+      topBucket(top - 1),
+      bottomBucket(bottom),
+      buckets(top - bottom),
+      edgeCount(0),
+      vertices(static_cast<Vertex *>(
+          operator new(buckets * sizeof(Vertex)))) {
+    for (std::size_t i = 0; i < buckets; i++) {
+      new (vertices + i) Vertex(&pool);
+    }
+  }
+
+  /**
+  * Incidences and edges live in the graph's pool and slabs, so remaining
+  * ones are freed all at once.
+  */
+  ~UnrolledRangedGraph() {
+    for (std::size_t i = 0; i < buckets; i++) {
+      vertices[i].~Vertex();
+    }
+    operator delete(vertices);
+    for (Edge *slab : slabs) {
+      delete[] slab;
+    }
+  }
+
+  UnrolledRangedGraph(const UnrolledRangedGraph &) = delete;
+  UnrolledRangedGraph &operator=(const UnrolledRangedGraph &) = delete;
+
+  void error() {
+    exit(1);
+  }
+
+#ifndef NO_CHECKS
+#define CHECK_UNROLLED_VERTEX(vertex) { \
+  if (vertex < bottomBucket || vertex > topBucket) error(); \
+}
+#else
+#define CHECK_UNROLLED_VERTEX(vertex)
+#endif
+
+  Vertex *getVertex(int vertex) {
+    CHECK_UNROLLED_VERTEX(vertex)
+    return &vertices[vertex - bottomBucket];
+  }
+
+  int degree(int vertex) {
+    return getVertex(vertex)->degree();
+  }
+
+  /**
+  * Applies a function taking (neighbor, edge) to every edge of a vertex.
+  * The graph must not be modified meanwhile.
+  */
+  template<class F>
+  void foreachNeighbor(int vertex, F apply) {
+    getVertex(vertex)->adjacency.foreach([&apply](Incidence &incidence) {
+      apply(incidence.neighbor, incidence.edge);
+    });
+  }
+
+  Edge *addEdge(int left, int right, E value) {
+    Vertex *l = getVertex(left);
+    Vertex *r = getVertex(right);
+    Edge *edge = allocateEdge();
+    edge->value = value;
+    edge->left = left;
+    edge->right = right;
+    l->adjacency.addLast(Incidence{right, edge}, &edge->leftSlot);
+    r->adjacency.addLast(Incidence{left, edge}, &edge->rightSlot);
+    edgeCount++;
+    return edge;
+  }
+
+  void removeEdge(Edge *edge) {
+    VC_STAT(edgesRemoved)
+    getVertex(edge->right)->adjacency.detach(&edge->rightSlot);
+    getVertex(edge->left)->adjacency.detach(&edge->leftSlot);
+    freed.push_back(edge);
+    edgeCount--;
+  }
+
+  void removeVertex(int vertex) {
+    VC_STAT(verticesRemoved)
+    UnrolledPositionalList<Incidence> &adjacency =
+        getVertex(vertex)->adjacency;
+    while (adjacency.size != 0) {
+      removeEdge(adjacency.back().edge);
+    }
+  }
+
+  private:
+  /** Edges handed out per slab. */
+  static const std::size_t SLAB_SIZE = 1024;
+
+  /**
+  * Shared by every adjacency list.  Only its chunks are used, since the
+  * slots live in the edges.
+  */
+  UnrolledPool<Incidence> pool;
+  Vertex *vertices;
+  std::vector<Edge *> slabs;
+  /** Edges handed out from the last slab so far. */
+  std::size_t used = SLAB_SIZE;
+  /** Removed edges, reused before the slabs. */
+  std::vector<Edge *> freed;
+
+  Edge *allocateEdge() {
+    if (!freed.empty()) {
+      Edge *edge = freed.back();
+      freed.pop_back();
+      return edge;
+    }
+    if (used == SLAB_SIZE) {
+      slabs.push_back(new Edge[SLAB_SIZE]);
+      used = 0;
+    }
+    return slabs.back() + used++;
+  }
+};
+
+#endif
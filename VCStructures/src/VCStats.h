@@ -0,0 +1,83 @@
+#ifndef VC_STATS__
+#define VC_STATS__
+
+#include <stdio.h>
+
+#include <cstdint>
+
+/**
+* Hot-path counters for the VCStructures containers.
+*
+* Compiled in only when VC_STATS is defined; otherwise every VC_STAT and
+* VC_STAT_ADD expands to nothing and the counters cost nothing.  Like
+* NO_CHECKS this is a whole-program choice and should be set the same way
+* for every translation unit.
+*
+* The counters are plain process-wide integers.  The containers are not
+* thread-safe themselves, so they are only bumped from one thread at a time.
+*/
+struct VCStats {
+  /** Positions allocated by PositionalLists, pooled or not. */
+  std::uint64_t positionAllocations;
+  /** Positions freed by PositionalLists. */
+  std::uint64_t positionFrees;
+  /** Slabs allocated by PositionPools. */
+  std::uint64_t slabAllocations;
+  /** RangedBuckets size increments (items entering any bucket). */
+  std::uint64_t bucketInserts;
+  /** RangedBuckets size decrements (items leaving any bucket). */
+  std::uint64_t bucketRemovals;
+  /** Positions moved between buckets in place (adapt and friends). */
+  std::uint64_t adaptMoves;
+  /** Occupancy searches for the next non-empty bucket. */
+  std::uint64_t occupancySearches;
+  /** Empty buckets jumped over by those searches. */
+  std::uint64_t emptyBucketsSkipped;
+  /** Priority deque pops from either end. */
+  std::uint64_t pops;
+  /** Edges removed from a graph, including through removeVertex. */
+  std::uint64_t edgesRemoved;
+  /** Calls to removeVertex. */
+  std::uint64_t verticesRemoved;
+
+  static VCStats &global() {
+    static VCStats stats = VCStats();
+    return stats;
+  }
+
+  void reset() {
+    *this = VCStats();
+  }
+
+  void print(FILE *out = stdout) {
+    fprintf(out, "  position allocations: %llu\n",
+        (unsigned long long) positionAllocations);
+    fprintf(out, "  position frees: %llu\n",
+        (unsigned long long) positionFrees);
+    fprintf(out, "  slab allocations: %llu\n",
+        (unsigned long long) slabAllocations);
+    fprintf(out, "  bucket inserts: %llu\n",
+        (unsigned long long) bucketInserts);
+    fprintf(out, "  bucket removals: %llu\n",
+        (unsigned long long) bucketRemovals);
+    fprintf(out, "  adapt moves: %llu\n", (unsigned long long) adaptMoves);
+    fprintf(out, "  occupancy searches: %llu\n",
+        (unsigned long long) occupancySearches);
+    fprintf(out, "  empty buckets skipped: %llu\n",
+        (unsigned long long) emptyBucketsSkipped);
+    fprintf(out, "  pops: %llu\n", (unsigned long long) pops);
+    fprintf(out, "  edges removed: %llu\n", (unsigned long long) edgesRemoved);
+    fprintf(out, "  vertices removed: %llu\n",
+        (unsigned long long) verticesRemoved);
+  }
+};
+
+#ifdef VC_STATS
+#define VC_STAT(counter) { VCStats::global().counter++; }
+#define VC_STAT_ADD(counter, amount) { VCStats::global().counter += (amount); }
+#else
+#define VC_STAT(counter)
+#define VC_STAT_ADD(counter, amount)
+#endif
+
+#endif
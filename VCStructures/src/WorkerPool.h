@@ -0,0 +1,130 @@
+#ifndef WORKER_POOL__
+#define WORKER_POOL__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* A fixed set of threads that run one job at a time, for code that hands out
+* many short parallel steps: the threads are started once, and each step
+* costs a wake-up rather than a thread creation and join.
+*
+* run(work) calls work(i) once for every i below threads, with the caller
+* itself taking i = 0, and returns when every call has returned.  Threads
+* waiting for a job or for the others to finish spin briefly, yielding, and
+* then sleep, so back-to-back steps hand over without a system call while an
+* idle pool costs nothing.
+*
+* run must not be called from a job, or by two threads at once.
+*/
+class WorkerPool {
+  public:
+  /** Threads taking part in each job, the caller included. */
+  const unsigned threads;
+
+  /** Yields before a waiting thread goes to sleep. */
+  static const int SPINS = 64;
+
+  /**
+  * @param threads Threads per job, the caller included; 0 for one per
+  * hardware thread.
+  */
+  WorkerPool(unsigned threads = 0) :
+      threads(threads != 0 ? threads :
+          (std::thread::hardware_concurrency() != 0 ?
+              std::thread::hardware_concurrency() : 1)),
+      call(nullptr),
+      context(nullptr),
+      generation(0),
+      pending(0),
+      stopping(false) {
+    for (unsigned i = 1; i < this->threads; i++) {
+      workers.push_back(std::thread(&WorkerPool::serve, this, i));
+    }
+  }
+
+  ~WorkerPool() {
+    stopping = true;
+    publish();
+    for (std::thread &worker : workers) {
+      worker.join();
+    }
+  }
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  template<class F>
+  void run(F &work) {
+    call = [](void *job, unsigned index) {
+      (*static_cast<F *>(job))(index);
+    };
+    context = &work;
+    pending.store(threads - 1, std::memory_order_relaxed);
+    publish();
+    work(0u);
+    for (int i = 0; i < SPINS && pending.load(std::memory_order_acquire) != 0;
+        i++) {
+      std::this_thread::yield();
+    }
+    if (pending.load(std::memory_order_acquire) != 0) {
+      std::unique_lock<std::mutex> lock(mutex);
+      done.wait(lock, [this]() {
+        return pending.load(std::memory_order_acquire) == 0;
+      });
+    }
+  }
+
+  private:
+  void (*call)(void *, unsigned);
+  void *context;
+  /** Bumped for every job, and once more to stop. */
+  std::atomic<unsigned> generation;
+  /** Workers yet to finish the current job. */
+  std::atomic<unsigned> pending;
+  bool stopping;
+  std::mutex mutex;
+  std::condition_variable started;
+  std::condition_variable done;
+  std::vector<std::thread> workers;
+
+  /**
+  * Hands the current job, or the stop request, to the workers.  The lock
+  * orders the bump against a worker about to sleep, so no wake-up is lost.
+  */
+  void publish() {
+    generation.fetch_add(1, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mutex);
+    started.notify_all();
+  }
+
+  void serve(unsigned index) {
+    unsigned seen = 0;
+    for (;;) {
+      for (int i = 0; i < SPINS &&
+          generation.load(std::memory_order_acquire) == seen; i++) {
+        std::this_thread::yield();
+      }
+      if (generation.load(std::memory_order_acquire) == seen) {
+        std::unique_lock<std::mutex> lock(mutex);
+        started.wait(lock, [this, seen]() {
+          return generation.load(std::memory_order_acquire) != seen;
+        });
+      }
+      seen = generation.load(std::memory_order_acquire);
+      if (stopping) {
+        return;
+      }
+      call(context, index);
+      if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.notify_one();
+      }
+    }
+  }
+};
+
+#endif
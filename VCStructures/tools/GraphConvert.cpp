@@ -0,0 +1,21 @@
+#include <stdio.h>
+
+#include "../src/GraphFile.h"
+
+/**
+* Converts a text edge list or DIMACS graph to the binary graph format that
+* MappedGraphFile maps.
+*
+* Usage: GraphConvert <input.txt> <output.vcg>
+*/
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <input.txt> <output.vcg>\n", argv[0]);
+    return 2;
+  }
+  if (!convertTextGraph(argv[1], argv[2])) {
+    fprintf(stderr, "Could not convert %s to %s\n", argv[1], argv[2]);
+    return 1;
+  }
+  return 0;
+}